@@ -0,0 +1,58 @@
+#include "arena.h"
+#include "setting.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_ALIGNMENT _Alignof(max_align_t)
+
+void init_arena(Arena *arena)
+{
+	arena->block = NULL;
+}
+
+void *arena_alloc(Arena *arena, size_t size)
+{
+	Arena_Block *block = arena->block;
+	size = (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+	if (!block || block->size - block->used < size) {
+		size_t block_size =
+		    size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+		block = (Arena_Block *)malloc(sizeof(Arena_Block) + block_size);
+		block->next = arena->block;
+		block->size = block_size;
+		block->used = 0;
+		arena->block = block;
+	}
+	void *memory = block->data + block->used;
+	block->used += size;
+	return memory;
+}
+
+char *arena_strndup(Arena *arena, const char *value, size_t length)
+{
+	char *copy = (char *)arena_alloc(arena, length + 1);
+	memcpy(copy, value, length);
+	copy[length] = '\0';
+	return copy;
+}
+
+void reset_arena(Arena *arena)
+{
+	if (!arena->block)
+		return;
+	Arena_Block *block = arena->block->next;
+	while (block) {
+		Arena_Block *next = block->next;
+		free(block);
+		block = next;
+	}
+	arena->block->next = NULL;
+	arena->block->used = 0;
+}
+
+void clean_arena(Arena *arena)
+{
+	reset_arena(arena);
+	free(arena->block);
+	arena->block = NULL;
+}
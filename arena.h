@@ -0,0 +1,67 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/**
+ * struct arena_block (Arena_Block) - a block of memory of an arena.
+ * @next:	the previously allocated block
+ * @size:	the usable size of the block
+ * @used:	how much of the block is allocated
+ * @data:	the memory of the block
+ */
+typedef struct arena_block {
+	struct arena_block *next;
+	size_t size;
+	size_t used;
+	_Alignas(max_align_t) char data[];
+} Arena_Block;
+
+/**
+ * struct arena (Arena) - a bump allocator, everything allocated in the arena
+ * is released at once.
+ * @block:	the block being allocated from, linked to the older ones
+ */
+typedef struct arena {
+	Arena_Block *block;
+} Arena;
+
+/**
+ * init_arena() - initialize an empty arena.
+ * @arena:	the &Arena
+ */
+void init_arena(Arena *arena);
+
+/**
+ * arena_alloc() - allocate memory in the arena, aligned for any type.
+ * @arena:	the &Arena
+ * @size:	the size to allocate
+ *
+ * Return: 	pointer to the allocated memory
+ */
+void *arena_alloc(Arena *arena, size_t size);
+
+/**
+ * arena_strndup() - copy a string into the arena.
+ * @arena:	the &Arena
+ * @value:	the string
+ * @length:	the length of the string
+ *
+ * Return: 	pointer to the NUL-terminated copy
+ */
+char *arena_strndup(Arena *arena, const char *value, size_t length);
+
+/**
+ * reset_arena() - release everything allocated in the arena but keep its
+ * latest block for reuse.
+ * @arena:	the &Arena
+ */
+void reset_arena(Arena *arena);
+
+/**
+ * clean_arena() - release the arena and all its blocks.
+ * @arena:	the &Arena
+ */
+void clean_arena(Arena *arena);
+
+#endif /* ARENA_H */
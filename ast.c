@@ -0,0 +1,163 @@
+#include "ast.h"
+#include "setting.h"
+#include "token_table.h"
+#include <stdlib.h>
+
+_Static_assert(NON_TERMINAL_COUNT + TOKEN_KIND_COUNT <= UINT8_MAX,
+	       "AST node kinds do not fit in a byte");
+
+const char *non_terminal_names[] = {"<program>",
+				    "<compound_statement>",
+				    "<statement>",
+				    "<simple_statement>",
+				    "<assignment_statement>",
+				    "<read_statement>",
+				    "<write_statement>",
+				    "<structured_statement>",
+				    "<if_statement>",
+				    "<while_statement>",
+				    "<expression>",
+				    "<simple_expression>",
+				    "<term>",
+				    "<factor>",
+				    NULL};
+
+void init_ast(Ast *ast)
+{
+	ast->nodes = NULL;
+	ast->node_count = 0;
+	ast->node_capacity = 0;
+	ast->stack = NULL;
+	ast->depth = 0;
+	ast->stack_capacity = 0;
+	ast->end = 0;
+}
+
+/* make a node the last child of the innermost node being built */
+static void link_node(Ast *ast, uint32_t index)
+{
+	if (!ast->depth)
+		return;
+	Ast_Frame *parent = ast->stack + ast->depth - 1;
+	if (parent->last_child == AST_NONE)
+		parent->first_child = index;
+	else
+		ast->nodes[parent->last_child].next_sibling = index;
+	parent->last_child = index;
+}
+
+static uint32_t add_node(Ast *ast, int kind, uint32_t offset, uint32_t length,
+			 uint32_t first_child)
+{
+	if (ast->node_count == ast->node_capacity) {
+		ast->node_capacity = ast->node_capacity * 2 + 1024;
+		ast->nodes = (Ast_Node *)realloc(
+		    ast->nodes, ast->node_capacity * sizeof(Ast_Node));
+	}
+	uint32_t index = ast->node_count++;
+	Ast_Node *node = ast->nodes + index;
+	node->first_child = first_child;
+	node->next_sibling = AST_NONE;
+	node->offset = offset;
+	node->length = length;
+	node->kind = kind;
+	return index;
+}
+
+void ast_enter(Ast *ast, int non_terminal, uint32_t offset)
+{
+	if (ast->depth == ast->stack_capacity) {
+		ast->stack_capacity = ast->stack_capacity * 2 + 64;
+		ast->stack = (Ast_Frame *)realloc(
+		    ast->stack, ast->stack_capacity * sizeof(Ast_Frame));
+	}
+	Ast_Frame *frame = ast->stack + ast->depth++;
+	frame->offset = offset;
+	frame->kind = non_terminal;
+	frame->first_child = AST_NONE;
+	frame->last_child = AST_NONE;
+}
+
+void ast_exit(Ast *ast)
+{
+	if (!ast->depth)
+		return;
+	Ast_Frame *frame = ast->stack + --ast->depth;
+	uint32_t index = frame->first_child;
+	/* a non-terminal with a single child is replaced by the child */
+	if (index == AST_NONE || index != frame->last_child) {
+		/* a non-terminal spans up to its last terminal */
+		uint32_t length =
+		    ast->end > frame->offset ? ast->end - frame->offset : 0;
+		index = add_node(ast, frame->kind, frame->offset, length,
+				 frame->first_child);
+	}
+	link_node(ast, index);
+}
+
+void ast_add_terminal(Ast *ast, int kind, uint32_t offset, uint32_t length)
+{
+	link_node(ast, add_node(ast, NON_TERMINAL_COUNT + kind, offset, length,
+				AST_NONE));
+	ast->end = offset + length;
+}
+
+void ast_finish(Ast *ast)
+{
+	while (ast->depth)
+		ast_exit(ast);
+}
+
+void print_ast(Ast *ast, Output *out, const char *content)
+{
+	if (!ast->node_count)
+		return;
+	/* walk the tree in preorder, keeping the path to the current node */
+	uint32_t *path = (uint32_t *)malloc(64 * sizeof(uint32_t));
+	int depth = 0, path_capacity = 64;
+	uint32_t index = ast_root(ast);
+	for (;;) {
+		Ast_Node *node = ast->nodes + index;
+		int indent = depth * PARSE_DISPLAY_TAB_LENGTH;
+		if (ast_is_terminal(node))
+			output_printf(out, "%*s%s '%.*s'\n", indent, "",
+				      token_kind_names[node->kind -
+						       NON_TERMINAL_COUNT],
+				      (int)node->length, content + node->offset);
+		else
+			output_printf(out, "%*s%s [%u-%u]\n", indent, "",
+				      non_terminal_names[node->kind],
+				      node->offset, node->offset + node->length);
+		if (node->first_child != AST_NONE) {
+			if (depth == path_capacity) {
+				path_capacity *= 2;
+				path = (uint32_t *)realloc(
+				    path, path_capacity * sizeof(uint32_t));
+			}
+			path[depth++] = index;
+			index = node->first_child;
+			continue;
+		}
+		/* go up until a node has a next sibling */
+		while (ast->nodes[index].next_sibling == AST_NONE && depth)
+			index = path[--depth];
+		if (ast->nodes[index].next_sibling == AST_NONE)
+			break;
+		index = ast->nodes[index].next_sibling;
+	}
+	free(path);
+}
+
+void reset_ast(Ast *ast)
+{
+	ast->node_count = 0;
+	ast->depth = 0;
+	ast->end = 0;
+}
+
+void clean_ast(Ast *ast)
+{
+	free(ast->nodes);
+	free(ast->stack);
+	init_ast(ast);
+}
@@ -0,0 +1,172 @@
+#ifndef AST_H
+#define AST_H
+
+#include "output.h"
+#include <stdint.h>
+
+/* marks the absence of a child or of a sibling */
+#define AST_NONE UINT32_MAX
+
+/* kind of the non-terminals of the grammar, the kind of an AST node being
+ * either a non-terminal or NON_TERMINAL_COUNT + the kind of a terminal token
+ * (see &enum token_kind) */
+enum non_terminal {
+	NT_PROGRAM,
+	NT_COMPOUND_STATEMENT,
+	NT_STATEMENT,
+	NT_SIMPLE_STATEMENT,
+	NT_ASSIGNMENT_STATEMENT,
+	NT_READ_STATEMENT,
+	NT_WRITE_STATEMENT,
+	NT_STRUCTURED_STATEMENT,
+	NT_IF_STATEMENT,
+	NT_WHILE_STATEMENT,
+	NT_EXPRESSION,
+	NT_SIMPLE_EXPRESSION,
+	NT_TERM,
+	NT_FACTOR,
+	NON_TERMINAL_COUNT
+};
+
+/* name of each non-terminal */
+extern const char *non_terminal_names[];
+
+/**
+ * struct ast_node (Ast_Node) - a node of the abstract syntax tree, the
+ * children of a node being linked through their @next_sibling.
+ * @first_child:	index of the first child, or AST_NONE
+ * @next_sibling:	index of the next sibling, or AST_NONE
+ * @offset:		position of the node in the input
+ * @length:		length of the input covered by the node
+ * @kind:		the kind of the node (see &enum non_terminal)
+ */
+typedef struct ast_node {
+	uint32_t first_child;
+	uint32_t next_sibling;
+	uint32_t offset;
+	uint32_t length;
+	uint8_t kind;
+} Ast_Node;
+
+/**
+ * struct ast_frame (Ast_Frame) - a non-terminal node being built.
+ * @offset:		position of the non-terminal in the input
+ * @kind:		the kind of the non-terminal
+ * @first_child:	index of its first child so far, or AST_NONE
+ * @last_child:		index of its last child so far, or AST_NONE
+ */
+typedef struct ast_frame {
+	uint32_t offset;
+	int kind;
+	uint32_t first_child;
+	uint32_t last_child;
+} Ast_Frame;
+
+/**
+ * struct ast (Ast) - an abstract syntax tree, its nodes being bump-allocated
+ * in a single growing array (so they are referred to by index).
+ * @nodes:		the nodes, in postorder so the root is the last one
+ * @node_count:		the number of nodes
+ * @node_capacity:	the allocated number of nodes
+ * @stack:		the non-terminal nodes being built, innermost last
+ * @depth:		the number of nodes in @stack
+ * @stack_capacity:	the allocated size of @stack
+ * @end:		the end of the last terminal added
+ *
+ * A node is only created once all its children are, and a non-terminal with
+ * a single child is replaced by that child (e.g. an <expression> made of a
+ * single <variable>), which keeps the tree much smaller than the parse tree.
+ */
+typedef struct ast {
+	Ast_Node *nodes;
+	uint32_t node_count;
+	uint32_t node_capacity;
+	Ast_Frame *stack;
+	int depth;
+	int stack_capacity;
+	uint32_t end;
+} Ast;
+
+/**
+ * ast_is_terminal() - check if a node is a terminal.
+ * @node:	the &Ast_Node
+ *
+ * Return: 	0: the node is a non-terminal
+ * 		1: the node is a terminal
+ */
+static inline int ast_is_terminal(const Ast_Node *node)
+{
+	return node->kind >= NON_TERMINAL_COUNT;
+}
+
+/**
+ * ast_root() - get the root of a finished tree.
+ * @ast:	the &Ast
+ *
+ * Return: 	index of the root, or AST_NONE if the tree is empty
+ */
+static inline uint32_t ast_root(const Ast *ast)
+{
+	return ast->node_count ? ast->node_count - 1 : AST_NONE;
+}
+
+/**
+ * init_ast() - initialize an empty tree.
+ * @ast:	the &Ast
+ */
+void init_ast(Ast *ast);
+
+/**
+ * ast_enter() - start a non-terminal node, as the last child of the innermost
+ * node being built.
+ * @ast:		the &Ast
+ * @non_terminal:	the kind of the non-terminal
+ * @offset:		the position of the non-terminal in the input
+ */
+void ast_enter(Ast *ast, int non_terminal, uint32_t offset);
+
+/**
+ * ast_exit() - end the innermost non-terminal node being built and create it
+ * (unless it has a single child).
+ * @ast:	the &Ast
+ */
+void ast_exit(Ast *ast);
+
+/**
+ * ast_add_terminal() - add a terminal node as the last child of the innermost
+ * node being built.
+ * @ast:	the &Ast
+ * @kind:	the kind of the token
+ * @offset:	the position of the lexeme in the input
+ * @length:	the length of the lexeme
+ */
+void ast_add_terminal(Ast *ast, int kind, uint32_t offset, uint32_t length);
+
+/**
+ * ast_finish() - end all the non-terminal nodes still being built (the parser
+ * stops early on unexpected EOF).
+ * @ast:	the &Ast
+ */
+void ast_finish(Ast *ast);
+
+/**
+ * print_ast() - print the tree, one node per line, indented by depth.
+ * @ast:	the &Ast
+ * @out:	the &Output
+ * @content:	the input the tree was built from
+ */
+void print_ast(Ast *ast, Output *out, const char *content);
+
+/**
+ * reset_ast() - empty the tree, keeping its memory for the next one.
+ * @ast:	the &Ast
+ */
+void reset_ast(Ast *ast);
+
+/**
+ * clean_ast() - cleanup the tree.
+ * @ast:	the &Ast
+ */
+void clean_ast(Ast *ast);
+
+#endif /* AST_H */
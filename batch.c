@@ -0,0 +1,288 @@
+#include "batch.h"
+#include "context.h"
+#include "parser.h"
+#include "setting.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+/**
+ * struct batch_job (Batch_Job) - a file to parse in batch mode.
+ * @file_name:	name of the file
+ * @size:	size of the file, used for scheduling
+ * @status:	the value returned by parse_file()
+ * @out:	the messages of the parser for this file
+ * @is_done:	boolean indicates if the file has been parsed
+ */
+typedef struct batch_job {
+	char *file_name;
+	off_t size;
+	int status;
+	Output out;
+	int is_done;
+} Batch_Job;
+
+/**
+ * struct job_queue (Job_Queue) - the jobs dealt to a worker, the worker takes
+ * them from the front while the other workers steal them from the back.
+ * @jobs:	indices of the jobs, largest file first
+ * @head:	position of the next job to take
+ * @tail:	position after the last job
+ * @lock:	protect @head and @tail
+ */
+typedef struct job_queue {
+	int *jobs;
+	int head;
+	int tail;
+	pthread_mutex_t lock;
+} Job_Queue;
+
+/**
+ * struct batch (Batch) - the state shared by the workers.
+ * @jobs:		the jobs, in input order
+ * @job_count:		the number of jobs
+ * @queues:		one queue per worker
+ * @worker_count:	the number of workers
+ * @options:		the &Parse_Options of every file
+ * @lock:		protect the is_done flags of the jobs
+ * @job_done:		signaled whenever a job is done
+ */
+typedef struct batch {
+	Batch_Job *jobs;
+	int job_count;
+	Job_Queue *queues;
+	int worker_count;
+	Parse_Options *options;
+	pthread_mutex_t lock;
+	pthread_cond_t job_done;
+} Batch;
+
+/**
+ * struct worker (Worker) - argument of a worker thread.
+ * @batch:	the &Batch
+ * @id:		index of the worker, and of its queue
+ */
+typedef struct worker {
+	Batch *batch;
+	int id;
+} Worker;
+
+static void add_job(Batch_Job **jobs, int *count, int *capacity,
+		    char *file_name)
+{
+	if (*count == *capacity) {
+		*capacity = *capacity * 2 + 16;
+		*jobs = (Batch_Job *)realloc(*jobs,
+					     *capacity * sizeof(Batch_Job));
+	}
+	Batch_Job *job = *jobs + (*count)++;
+	struct stat file_stat;
+	job->file_name = file_name;
+	job->size = stat(file_name, &file_stat) ? 0 : file_stat.st_size;
+	job->status = 0;
+	job->is_done = 0;
+	init_output(&job->out, NULL);
+}
+
+static int read_file_list(char *list_file, Batch_Job **jobs, int *count,
+			  int *capacity)
+{
+	FILE *file = strcmp(list_file, "-") ? fopen(list_file, "r") : stdin;
+	if (!file) {
+		printf("%sERROR - cannot open file: %s%s\n", ERROR_COL,
+		       list_file, COL_RESET);
+		return -1;
+	}
+	char *line = NULL;
+	size_t line_capacity = 0;
+	ssize_t length;
+	while ((length = getline(&line, &line_capacity, file)) != -1) {
+		while (length && (line[length - 1] == '\n' ||
+				  line[length - 1] == '\r'))
+			line[--length] = '\0';
+		if (length)
+			add_job(jobs, count, capacity, strdup(line));
+	}
+	free(line);
+	if (file != stdin)
+		fclose(file);
+	return 0;
+}
+
+static Batch_Job *sorted_jobs;
+
+static int compare_job_size(const void *a, const void *b)
+{
+	const Batch_Job *job_a = sorted_jobs + *(const int *)a;
+	const Batch_Job *job_b = sorted_jobs + *(const int *)b;
+	if (job_a->size != job_b->size)
+		return job_a->size < job_b->size ? 1 : -1;
+	return *(const int *)a - *(const int *)b;
+}
+
+static int take_job(Job_Queue *queue)
+{
+	int job = -1;
+	pthread_mutex_lock(&queue->lock);
+	if (queue->head < queue->tail)
+		job = queue->jobs[queue->head++];
+	pthread_mutex_unlock(&queue->lock);
+	return job;
+}
+
+static int steal_job(Job_Queue *queue)
+{
+	int job = -1;
+	pthread_mutex_lock(&queue->lock);
+	if (queue->head < queue->tail)
+		job = queue->jobs[--queue->tail];
+	pthread_mutex_unlock(&queue->lock);
+	return job;
+}
+
+static void *run_worker(void *argument)
+{
+	Worker *worker = (Worker *)argument;
+	Batch *batch = worker->batch;
+	Parse_Context context;
+	for (;;) {
+		int job = take_job(batch->queues + worker->id);
+		/* steal from the other workers once out of jobs, the queues
+		 * are never refilled so an empty round means all is taken */
+		for (int i = 1; job < 0 && i < batch->worker_count; ++i)
+			job = steal_job(batch->queues +
+					(worker->id + i) % batch->worker_count);
+		if (job < 0)
+			break;
+
+		init_context(&context, batch->options, NULL);
+		int status = parse_file(&context, batch->jobs[job].file_name);
+		pthread_mutex_lock(&batch->lock);
+		batch->jobs[job].status = status;
+		batch->jobs[job].out = context.out;
+		batch->jobs[job].is_done = 1;
+		pthread_cond_broadcast(&batch->job_done);
+		pthread_mutex_unlock(&batch->lock);
+		/* the messages now belong to the job */
+		init_output(&context.out, NULL);
+		clean_context(&context);
+	}
+	return NULL;
+}
+
+int run_batch(char **file_names, int file_count, char *list_file,
+	      int job_count, Parse_Options *options)
+{
+	Batch batch;
+	batch.options = options;
+	int capacity = 0;
+	batch.jobs = NULL;
+	batch.job_count = 0;
+	for (int i = 0; i < file_count; ++i)
+		add_job(&batch.jobs, &batch.job_count, &capacity,
+			strdup(file_names[i]));
+	if (list_file && read_file_list(list_file, &batch.jobs,
+					&batch.job_count, &capacity)) {
+		for (int i = 0; i < batch.job_count; ++i)
+			free(batch.jobs[i].file_name);
+		free(batch.jobs);
+		return 2;
+	}
+
+	/* deal the jobs to the workers round-robin, largest file first */
+	int *order = (int *)malloc((batch.job_count + 1) * sizeof(int));
+	for (int i = 0; i < batch.job_count; ++i)
+		order[i] = i;
+	sorted_jobs = batch.jobs;
+	qsort(order, batch.job_count, sizeof(int), compare_job_size);
+	batch.worker_count =
+	    job_count < batch.job_count ? job_count : batch.job_count;
+	if (batch.worker_count < 1)
+		batch.worker_count = 1;
+	batch.queues =
+	    (Job_Queue *)malloc(batch.worker_count * sizeof(Job_Queue));
+	for (int i = 0; i < batch.worker_count; ++i) {
+		Job_Queue *queue = batch.queues + i;
+		queue->jobs = (int *)malloc(
+		    (batch.job_count / batch.worker_count + 1) * sizeof(int));
+		queue->head = 0;
+		queue->tail = 0;
+		pthread_mutex_init(&queue->lock, NULL);
+	}
+	for (int i = 0; i < batch.job_count; ++i) {
+		Job_Queue *queue = batch.queues + i % batch.worker_count;
+		queue->jobs[queue->tail++] = order[i];
+	}
+	free(order);
+
+	pthread_mutex_init(&batch.lock, NULL);
+	pthread_cond_init(&batch.job_done, NULL);
+	pthread_t *threads =
+	    (pthread_t *)malloc(batch.worker_count * sizeof(pthread_t));
+	Worker *workers =
+	    (Worker *)malloc(batch.worker_count * sizeof(Worker));
+	for (int i = 0; i < batch.worker_count; ++i) {
+		workers[i].batch = &batch;
+		workers[i].id = i;
+		pthread_create(threads + i, NULL, run_worker, workers + i);
+	}
+
+	/* print the messages in input order as soon as they are available */
+	int error_count = 0, failure_count = 0;
+	int is_text = options->format == OUTPUT_TEXT;
+	Output out;
+	init_output(&out, stdout);
+	print_report_header(&out, options->format);
+	for (int i = 0; i < batch.job_count; ++i) {
+		Batch_Job *job = batch.jobs + i;
+		pthread_mutex_lock(&batch.lock);
+		while (!job->is_done)
+			pthread_cond_wait(&batch.job_done, &batch.lock);
+		pthread_mutex_unlock(&batch.lock);
+		if (is_text)
+			output_printf(&out, "%sFILE - %s%s\n", INFO_COL,
+				      job->file_name, COL_RESET);
+		else if (out.record_count && job->out.record_count &&
+			 options->format == OUTPUT_SARIF)
+			output_write(&out, ",", 1);
+		if (job->out.length)
+			output_write(&out, job->out.buffer, job->out.length);
+		out.record_count += job->out.record_count;
+		clean_output(&job->out);
+		if (job->status < 0)
+			++failure_count;
+		else if (job->status > 0)
+			++error_count;
+	}
+	if (is_text)
+		output_printf(&out,
+			      "%sSUMMARY - %d file(s) parsed, %d with error(s), "
+			      "%d could not be loaded%s\n",
+			      failure_count || error_count ? ERROR_COL
+							   : SUCCESS_COL,
+			      batch.job_count, error_count, failure_count,
+			      COL_RESET);
+	print_report_footer(&out, options->format);
+	clean_output(&out);
+
+	/* cleanup, once no worker can steal from any queue anymore */
+	for (int i = 0; i < batch.worker_count; ++i)
+		pthread_join(threads[i], NULL);
+	for (int i = 0; i < batch.worker_count; ++i) {
+		free(batch.queues[i].jobs);
+		pthread_mutex_destroy(&batch.queues[i].lock);
+	}
+	for (int i = 0; i < batch.job_count; ++i)
+		free(batch.jobs[i].file_name);
+	pthread_mutex_destroy(&batch.lock);
+	pthread_cond_destroy(&batch.job_done);
+	free(threads);
+	free(workers);
+	free(batch.queues);
+	free(batch.jobs);
+	if (failure_count)
+		return 2;
+	return error_count ? 1 : 0;
+}
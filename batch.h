@@ -0,0 +1,27 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "context.h"
+
+/**
+ * run_batch() - parse several files concurrently on a pool of worker
+ * threads, then print the messages of each file in the order they are given
+ * followed by a summary.
+ * @file_names: 	names of the files to parse
+ * @file_count: 	the number of files in @file_names
+ * @list_file: 		name of a file listing more files to parse, one per
+ * 			line ("-" for the standard input), or NULL
+ * @job_count: 		the number of worker threads
+ * @options: 		the &Parse_Options of every file
+ *
+ * The files are handed out largest first, and a worker which runs out of
+ * files steals from the others.
+ *
+ * Return: 	0: every file was parsed without error
+ * 		1: some file has error(s)
+ * 		2: some file could not be loaded
+ */
+int run_batch(char **file_names, int file_count, char *list_file,
+	      int job_count, Parse_Options *options);
+
+#endif /* BATCH_H */
@@ -0,0 +1,242 @@
+#include "code_display.h"
+#include "setting.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void init_error_index(Error_Index *index, Parse_Context *context)
+{
+	size_t count = 0;
+	Parse_Error *error;
+	for (error = context->error_list; error; error = error->next)
+		++count;
+	index->errors = (Parse_Error **)malloc(count * sizeof(Parse_Error *));
+	index->spans = (Column_Span *)malloc(count * sizeof(Column_Span));
+	index->count = 0;
+	for (error = context->error_list; error; error = error->next)
+		index->errors[index->count++] = error;
+	index->first = 0;
+	index->last = 0;
+	index->has_ended = 0;
+	index->is_junk = context->error_junk_after_program_end;
+	index->span_count = 0;
+	index->end_col = INT_MAX;
+}
+
+static void clean_error_index(Error_Index *index)
+{
+	free(index->errors);
+	free(index->spans);
+}
+
+/* find the spans of the given line, the lines being matched in order */
+static void match_line(Error_Index *index, int line)
+{
+	index->span_count = 0;
+	index->end_col = INT_MAX;
+	if (index->has_ended || index->errors[0]->line_number > line)
+		return;
+	/* get to the errors of the line */
+	while (index->first < index->count &&
+	       index->errors[index->first]->line_number < line)
+		++index->first;
+	if (index->first == index->count) {
+		/* the line is past the last error */
+		index->end_col = INT_MIN;
+		return;
+	}
+	if (index->last < index->first)
+		index->last = index->first;
+	while (index->last + 1 < index->count &&
+	       index->errors[index->last + 1]->line_number <= line)
+		++index->last;
+
+	/* a column goes to the first error which does not end before it */
+	long long passed_col = LLONG_MIN;
+	for (size_t i = index->first; i <= index->last; ++i) {
+		Parse_Error *error = index->errors[i];
+		long long last_col = error->end_col - 1LL;
+		if (last_col <= passed_col)
+			continue;
+		long long start_col = error->start_col > passed_col
+					  ? error->start_col
+					  : passed_col + 1;
+		if (error->line_number == line && start_col <= last_col) {
+			Column_Span *span = &index->spans[index->span_count++];
+			span->start = start_col;
+			span->end = last_col;
+		}
+		passed_col = last_col;
+	}
+	if (index->last + 1 == index->count)
+		index->end_col = passed_col + 1;
+}
+
+/* boolean indicates if the character of the given column is highlighted,
+ * @span being the first span of the line not before the previous one */
+static int is_marked(Error_Index *index, int col, size_t *span)
+{
+	if (index->has_ended)
+		return index->is_junk;
+	if (col >= index->end_col) {
+		/* only the characters after it are matched as past the end */
+		index->has_ended = 1;
+		return 0;
+	}
+	while (*span < index->span_count && index->spans[*span].end < col)
+		++*span;
+	return *span < index->span_count && index->spans[*span].start <= col;
+}
+
+/* print a highlighted character, a newline after a highlighted space */
+static void print_marked(Output *out, char current_char)
+{
+	static const char start[] = CODE_DISPLAY_ERROR_COL;
+	static const char reset[] = COL_RESET;
+	char marked[sizeof(start) + sizeof(reset) + 1];
+	size_t length = sizeof(start) - 1;
+	memcpy(marked, start, length);
+	if (current_char == '\n')
+		marked[length++] = ' ';
+	marked[length++] = current_char;
+	memcpy(marked + length, reset, sizeof(reset) - 1);
+	output_write(out, marked, length + sizeof(reset) - 1);
+}
+
+/* print the line from @start to @end, the newline before it (if
+ * @has_newline) being matched at column -1 of the line and printed if
+ * @is_newline_shown */
+static void print_line(Error_Index *index, Output *out, const char *content,
+		       size_t start, size_t end, int has_newline,
+		       int is_newline_shown)
+{
+	size_t first = has_newline ? start - 1 : start;
+	size_t run = is_newline_shown ? first : start;
+	/* nothing to highlight, the line is written at once */
+	int is_plain = index->has_ended ? !index->is_junk
+					: !index->span_count &&
+					      index->end_col == INT_MAX;
+	if (is_plain) {
+		output_write(out, content + run, end - run);
+		return;
+	}
+	int current_col = -1;
+	size_t span = 0;
+	for (size_t i = first; i < end; ++i) {
+		if (content[i] == '\n')
+			current_col = -1;
+		else if (content[i] == '\t')
+			current_col += TAB_SIZE;
+		else
+			current_col++;
+		if (!is_marked(index, current_col, &span) || i < run)
+			continue;
+		output_write(out, content + run, i - run);
+		print_marked(out, content[i]);
+		run = i + 1;
+	}
+	output_write(out, content + run, end - run);
+}
+
+/* match the line from @start to @end without printing it */
+static void skip_line(Error_Index *index, const char *content, size_t start,
+		      size_t end, int has_newline)
+{
+	if (index->has_ended || index->end_col == INT_MAX)
+		return;
+	/* the columns only grow along the line, the last one is enough */
+	long long last_col = has_newline ? -1 : LLONG_MIN;
+	if (end > start) {
+		size_t tab_count = 0;
+		for (size_t i = start; i < end; ++i)
+			tab_count += content[i] == '\t';
+		last_col = -1 + (long long)(end - start) +
+			   (long long)tab_count * (TAB_SIZE - 1);
+	}
+	if (last_col >= index->end_col)
+		index->has_ended = 1;
+}
+
+static int compare_lines(const void *a, const void *b)
+{
+	int line_a = *(const int *)a, line_b = *(const int *)b;
+	return (line_a > line_b) - (line_a < line_b);
+}
+
+void code_display(Parse_Context *context)
+{
+	Output *out = &context->out;
+	Source *input = &context->lexer.input;
+	/* the input is still mapped from the parsing */
+	const char *content = input->content;
+	int context_lines = context->options.context_lines;
+	int is_whole = context_lines < 0;
+	Error_Index index;
+	init_error_index(&index, context);
+
+	/* the lines of the errors, in order, for --context */
+	int *error_lines = (int *)malloc(index.count * sizeof(int));
+	for (size_t i = 0; i < index.count; ++i)
+		error_lines[i] = index.errors[i]->line_number;
+	qsort(error_lines, index.count, sizeof(int), compare_lines);
+	size_t next_error_line = 0;
+	long long group_start = LLONG_MAX, group_end = LLONG_MIN;
+
+	size_t start = 0;
+	for (int line = 1;; ++line) {
+		const char *newline = input->length > start
+					  ? memchr(content + start, '\n',
+						   input->length - start)
+					  : NULL;
+		size_t end = newline ? (size_t)(newline - content)
+				     : input->length;
+		/* the next lines shown go from N lines before an error to N
+		 * lines after the last error they are close to */
+		if (!is_whole && line > group_end &&
+		    next_error_line < index.count) {
+			group_start = (long long)error_lines[next_error_line] -
+				      context_lines;
+			do {
+				group_end = (long long)
+						error_lines[next_error_line++] +
+					    context_lines;
+			} while (next_error_line < index.count &&
+				 error_lines[next_error_line] - context_lines <=
+				     group_end + 1);
+		}
+
+		match_line(&index, line);
+		if (is_whole) {
+			print_line(&index, out, content, start, end, line > 1,
+				   1);
+		} else if (line >= group_start && line <= group_end) {
+			if (line == group_start || line == 1)
+				output_printf(out, "%s[line %d]%s\n", DEBUG_COL,
+					      line, COL_RESET);
+			print_line(&index, out, content, start, end, line > 1,
+				   line > group_start && line > 1);
+			if (line == group_end || !newline) {
+				if (!newline && context->error_unexpected_eof)
+					print_marked(out, ' ');
+				output_printf(out, "\n");
+			}
+		} else if (line > group_end) {
+			/* no line left to show */
+			break;
+		} else {
+			skip_line(&index, content, start, end, line > 1);
+		}
+		if (!newline)
+			break;
+		start = end + 1;
+	}
+
+	if (is_whole) {
+		/* handle unexpected EOF error */
+		if (context->error_unexpected_eof)
+			print_marked(out, ' ');
+		output_printf(out, "\n");
+	}
+	free(error_lines);
+	clean_error_index(&index);
+}
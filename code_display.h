@@ -0,0 +1,67 @@
+#ifndef CODE_DISPLAY_H
+#define CODE_DISPLAY_H
+
+#include "context.h"
+#include <stddef.h>
+
+/*
+ * The source code is printed after the messages with the characters of the
+ * errors highlighted. The errors are indexed once into an array, each line
+ * then being matched against them as a few spans of columns, so that the
+ * lines without errors are written at once whatever the number of errors.
+ */
+
+/**
+ * struct column_span (Column_Span) - columns of a line to be highlighted.
+ * @start:	the first column
+ * @end:	the last column
+ */
+typedef struct column_span {
+	int start;
+	int end;
+} Column_Span;
+
+/**
+ * struct error_index (Error_Index) - the errors in the order of the error
+ * list, matched against the lines in order.
+ * @errors:	the errors
+ * @count:	the number of @errors
+ * @first:	the first error not on a previous line
+ * @last:	the last error the matching of the current line can reach
+ * @has_ended:	boolean indicates if the matching ran past the last error, the
+ * 		rest of the input being highlighted only after junk after
+ * 		program end
+ * @is_junk:	boolean indicates if there is junk after program end
+ * @spans:	the spans of the current line, in order
+ * @span_count:	the number of @spans
+ * @end_col:	the column of the current line from which the matching runs
+ * 		past the last error (INT_MAX if it does not)
+ *
+ * A character is matched to the first error from @first on which does not
+ * end before it, as long as it is not past the errors of its line, then
+ * highlighted if it falls within that error.
+ */
+typedef struct error_index {
+	Parse_Error **errors;
+	size_t count;
+	size_t first;
+	size_t last;
+	int has_ended;
+	int is_junk;
+	Column_Span *spans;
+	size_t span_count;
+	int end_col;
+} Error_Index;
+
+/**
+ * code_display() - print the source code with its errors highlighted, either
+ * whole or only the lines around the errors (see &Parse_Options.context_lines).
+ * @context: 	the &Parse_Context
+ *
+ * The errors only know their line numbers, so the lines are gone through up
+ * to the last one shown even with --context, the lines not shown costing only
+ * the search of their newline.
+ */
+void code_display(Parse_Context *context);
+
+#endif /* CODE_DISPLAY_H */
@@ -0,0 +1,44 @@
+#include "context.h"
+#include <stdlib.h>
+#include <string.h>
+
+void init_context(Parse_Context *context, Parse_Options *options, FILE *file)
+{
+	memset(context, 0, sizeof(Parse_Context));
+	context->options = *options;
+	init_output(&context->out, file);
+	init_ast(&context->ast);
+	init_symbol_table(&context->symbols);
+}
+
+void reset_context(Parse_Context *context, Parse_Options *options)
+{
+	unload_input(&context->lexer);
+	reset_error_list(context);
+	context->options = *options;
+	context->file_name = NULL;
+	context->lex_token = NULL;
+	context->error_junk_after_program_end = 0;
+	context->error_unexpected_eof = 0;
+	context->error_count = 0;
+	context->is_recovering = 0;
+	context->has_given_up = 0;
+	context->display_depth = 0;
+	context->token_index = 0;
+	context->token_stream.state = STREAM_OFF;
+	reset_ast(&context->ast);
+	reset_symbol_table(&context->symbols);
+}
+
+void clean_context(Parse_Context *context)
+{
+	unload_input(&context->lexer);
+	clean_error_list(context);
+	clean_output(&context->out);
+	clean_ast(&context->ast);
+	clean_symbol_table(&context->symbols);
+	free(context->parse_stack);
+	context->parse_stack = NULL;
+	context->parse_stack_capacity = 0;
+	clean_token_stream(&context->token_stream);
+}
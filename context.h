@@ -0,0 +1,164 @@
+#ifndef CONTEXT_H
+#define CONTEXT_H
+
+#include "arena.h"
+#include "ast.h"
+#include "events.h"
+#include "lexical.h"
+#include "output.h"
+#include "parse_error.h"
+#include "pipeline.h"
+#include "symbol.h"
+#include "token_stream.h"
+#include "trace.h"
+
+/* what is done with the AST, it is not built at all by default */
+enum ast_mode { AST_MODE_NONE, AST_MODE_SUMMARY, AST_MODE_TREE };
+
+/* the syntax analyzer used, the recursive one by default */
+enum parse_engine { ENGINE_RECURSIVE, ENGINE_TABLE };
+
+/* what the syntax analyzer does after a syntax error: carry on as if the
+ * expected token had been seen (by default), or skip to a token which can
+ * follow the statement or the condition, reporting nothing more until a
+ * token is accepted */
+enum recovery_mode { RECOVERY_CONTINUE, RECOVERY_PANIC };
+
+/* when the input is lexed: along with the syntax analysis by default, all of
+ * it before (into the &Token_Stream), only lexed (token by token, or into the
+ * &Token_Stream), or ahead of the syntax analysis by another thread (through
+ * the &Token_Queue) */
+enum lex_mode {
+	LEX_MODE_INTERLEAVED,
+	LEX_MODE_FIRST,
+	LEX_MODE_ONLY,
+	LEX_MODE_ONLY_FIRST,
+	LEX_MODE_PIPELINED
+};
+
+typedef struct document Document;
+
+/**
+ * struct parse_options (Parse_Options) - the options given on the command
+ * line which affect the parsing of each input.
+ * @format:	the format of the diagnostics (see &enum output_format)
+ * @ast_mode:	whether the AST is built, and what is printed of it (see
+ * 		&enum ast_mode)
+ * @engine:	the syntax analyzer (see &enum parse_engine)
+ * @lex_mode:	when the input is lexed (see &enum lex_mode)
+ * @context_lines:	how many lines around each error the source code is
+ * 			shown with, the whole of it if negative
+ * @recovery:	what is done after a syntax error (see &enum recovery_mode)
+ * @max_errors:	how many errors are reported before giving up, 0 for no
+ * 		limit
+ * @symbols:	boolean indicates if the identifiers are interned into the
+ * 		&Symbol_Table of the context
+ */
+typedef struct parse_options {
+	int format;
+	int ast_mode;
+	int engine;
+	int lex_mode;
+	int context_lines;
+	int recovery;
+	int max_errors;
+	int symbols;
+} Parse_Options;
+
+/**
+ * struct parse_context (Parse_Context) - the whole state of the parsing of an
+ * input, so that several inputs can be parsed at the same time.
+ * @options:				the &Parse_Options
+ * @file_name:				name of the input file
+ * @lexer:				state of the lexical analyzer
+ * @lex_token:				the current token being checked
+ * @error_list:				the error list
+ * @error_tail:				the last error of the error list
+ * @error_arena:			holds the errors and their messages
+ * @error_junk_after_program_end:	boolean indicates if junk after
+ * 					program end was detected
+ * @error_unexpected_eof:		boolean indicates if unexpected EOF
+ * 					was detected
+ * @error_count:			the number of errors in the error list
+ * @is_recovering:			boolean indicates if the syntax analyzer
+ * 					is recovering from a syntax error
+ * 					(RECOVERY_PANIC only)
+ * @has_given_up:			boolean indicates if the parsing was
+ * 					stopped after @options.max_errors
+ * 					errors
+ * @display_depth:			depth of indentation of the syntax
+ * 					analyzer debugging messages
+ * @token_index:			the index of the current token (the
+ * 					number of tokens consumed so far)
+ * @trace:				the &Trace the syntax analysis is
+ * 					recorded into, or NULL
+ * @events:				the &Parse_Events the syntax analysis
+ * 					is reported to, or NULL
+ * @out:				the messages of the parser
+ * @ast:				the AST (if @options.ast_mode)
+ * @symbols:				the identifiers of the input (if
+ * 					@options.symbols)
+ * @document:				the &Document the tokens come from, or
+ * 					NULL to lex the input
+ * @parse_stack:			the symbols of the table-driven syntax
+ * 					analyzer
+ * @parse_stack_capacity:		the allocated number of @parse_stack
+ * @token_stream:			the tokens of the input, if lexed
+ * 					before the syntax analysis
+ * @token_queue:			the queue the tokens are read from, if
+ * 					lexed by another thread
+ * @lexer_queue:			the queue the tokens are sent to, in the
+ * 					context of the lexer thread
+ */
+typedef struct parse_context {
+	Parse_Options options;
+	char *file_name;
+	Lexer lexer;
+	Lex_Token *lex_token;
+	Parse_Error *error_list;
+	Parse_Error *error_tail;
+	Arena error_arena;
+	int error_junk_after_program_end;
+	int error_unexpected_eof;
+	int error_count;
+	int is_recovering;
+	int has_given_up;
+	int display_depth;
+	size_t token_index;
+	Trace *trace;
+	const Parse_Events *events;
+	Output out;
+	Ast ast;
+	Symbol_Table symbols;
+	Document *document;
+	uint16_t *parse_stack;
+	size_t parse_stack_capacity;
+	Token_Stream token_stream;
+	Token_Queue *token_queue;
+	Token_Queue *lexer_queue;
+} Parse_Context;
+
+/**
+ * init_context() - initialize the context for a new parsing.
+ * @context:	the &Parse_Context
+ * @options:	the &Parse_Options
+ * @file:	the file the messages go to, or NULL to keep them buffered in
+ * 		@context->out
+ */
+void init_context(Parse_Context *context, Parse_Options *options, FILE *file);
+
+/**
+ * reset_context() - get the context ready for parsing another input, keeping
+ * the memory it already has. The buffered messages are left to the caller.
+ * @context:	the &Parse_Context
+ * @options:	the &Parse_Options
+ */
+void reset_context(Parse_Context *context, Parse_Options *options);
+
+/**
+ * clean_context() - cleanup the context, flushing its messages.
+ * @context:	the &Parse_Context
+ */
+void clean_context(Parse_Context *context);
+
+#endif /* CONTEXT_H */
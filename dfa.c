@@ -0,0 +1,797 @@
+#include "dfa.h"
+#include "scan.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* types of the NFA nodes */
+enum nfa_type { NFA_EPSILON, NFA_SPLIT, NFA_SET, NFA_BOUNDARY, NFA_MATCH };
+
+/**
+ * struct nfa_node (Nfa_Node) - a node of the Thompson NFA.
+ * @type:	type of the node (see &enum nfa_type)
+ * @out:	the next node (-1 while the node is still dangling)
+ * @out1:	the alternative next node of a NFA_SPLIT node
+ * @set:	the index of the byte set consumed by a NFA_SET node
+ * @token:	the token index accepted by a NFA_MATCH node
+ */
+typedef struct nfa_node {
+	int type;
+	int out;
+	int out1;
+	int set;
+	int token;
+} Nfa_Node;
+
+/**
+ * struct byte_set (Byte_Set) - a set of bytes stored as a bitmap.
+ * @bits:	one bit per byte value
+ */
+typedef struct byte_set {
+	unsigned char bits[32];
+} Byte_Set;
+
+/**
+ * struct nfa (Nfa) - the NFA of all the patterns being compiled.
+ * @nodes:		list of nodes
+ * @node_count:		number of nodes
+ * @node_capacity:	allocated size of @nodes
+ * @sets:		list of distinct byte sets used by NFA_SET nodes
+ * @set_count:		number of byte sets
+ * @set_capacity:	allocated size of @sets
+ */
+typedef struct nfa {
+	Nfa_Node *nodes;
+	int node_count;
+	int node_capacity;
+	Byte_Set *sets;
+	int set_count;
+	int set_capacity;
+} Nfa;
+
+/**
+ * struct fragment (Fragment) - a partially built piece of NFA.
+ * @start:	the entry node
+ * @end:	the dangling NFA_EPSILON exit node
+ */
+typedef struct fragment {
+	int start;
+	int end;
+} Fragment;
+
+/**
+ * struct regex_parser (Regex_Parser) - state of the pattern parser.
+ * @p:		the current position in the pattern
+ * @nfa:	the NFA being built
+ * @error:	boolean indicates if the pattern is not supported
+ */
+typedef struct regex_parser {
+	const char *p;
+	Nfa *nfa;
+	int error;
+} Regex_Parser;
+
+#define SET_HAS(set, byte) ((set)->bits[(byte) >> 3] & (1 << ((byte)&7)))
+#define SET_ADD(set, byte) ((set)->bits[(byte) >> 3] |= (1 << ((byte)&7)))
+
+static int is_word_byte(int c)
+{
+	/* same definition of a word character as `\b` in glibc (C locale) */
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+	       (c >= '0' && c <= '9') || c == '_';
+}
+
+static int add_node(Nfa *nfa, int type)
+{
+	if (nfa->node_count == nfa->node_capacity) {
+		nfa->node_capacity = nfa->node_capacity * 2 + 64;
+		nfa->nodes = (Nfa_Node *)realloc(
+		    nfa->nodes, nfa->node_capacity * sizeof(Nfa_Node));
+	}
+	Nfa_Node *node = nfa->nodes + nfa->node_count;
+	node->type = type;
+	node->out = -1;
+	node->out1 = -1;
+	node->set = -1;
+	node->token = -1;
+	return nfa->node_count++;
+}
+
+static int add_set(Nfa *nfa, Byte_Set *set)
+{
+	/* identical sets are shared so they produce fewer input classes */
+	for (int i = 0; i < nfa->set_count; ++i) {
+		if (!memcmp(nfa->sets + i, set, sizeof(Byte_Set)))
+			return i;
+	}
+	if (nfa->set_count == nfa->set_capacity) {
+		nfa->set_capacity = nfa->set_capacity * 2 + 16;
+		nfa->sets = (Byte_Set *)realloc(
+		    nfa->sets, nfa->set_capacity * sizeof(Byte_Set));
+	}
+	nfa->sets[nfa->set_count] = *set;
+	return nfa->set_count++;
+}
+
+static Fragment single(Nfa *nfa, int type, int set)
+{
+	Fragment fragment;
+	fragment.start = add_node(nfa, type);
+	fragment.end = add_node(nfa, NFA_EPSILON);
+	nfa->nodes[fragment.start].set = set;
+	nfa->nodes[fragment.start].out = fragment.end;
+	return fragment;
+}
+
+static Fragment byte_set_fragment(Nfa *nfa, Byte_Set *set)
+{
+	return single(nfa, NFA_SET, add_set(nfa, set));
+}
+
+static int add_char_class(Byte_Set *set, const char *name, size_t length)
+{
+	static const char *names[] = {"alpha", "digit", "alnum", "upper",
+				      "lower", "space", "blank", "punct",
+				      "xdigit", "cntrl", "print", "graph"};
+	int class = -1;
+	for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); ++i) {
+		if (strlen(names[i]) == length &&
+		    !strncmp(names[i], name, length))
+			class = i;
+	}
+	if (class < 0)
+		return -1;
+	/* character classes of the C locale */
+	for (int c = 0; c < 128; ++c) {
+		int upper = c >= 'A' && c <= 'Z';
+		int lower = c >= 'a' && c <= 'z';
+		int digit = c >= '0' && c <= '9';
+		int space = c == ' ' || (c >= '\t' && c <= '\r');
+		int print = c >= ' ' && c < 127;
+		int member = 0;
+		switch (class) {
+		case 0: member = upper || lower; break;
+		case 1: member = digit; break;
+		case 2: member = upper || lower || digit; break;
+		case 3: member = upper; break;
+		case 4: member = lower; break;
+		case 5: member = space; break;
+		case 6: member = c == ' ' || c == '\t'; break;
+		case 7: member = print && c != ' ' && !upper && !lower &&
+				 !digit;
+			break;
+		case 8: member = digit || (c >= 'a' && c <= 'f') ||
+				 (c >= 'A' && c <= 'F');
+			break;
+		case 9: member = c < ' ' || c == 127; break;
+		case 10: member = print; break;
+		case 11: member = print && c != ' '; break;
+		}
+		if (member)
+			SET_ADD(set, c);
+	}
+	return 0;
+}
+
+static Fragment parse_bracket(Regex_Parser *parser)
+{
+	Byte_Set set;
+	int negate = 0;
+	memset(&set, 0, sizeof(set));
+	if (*parser->p == '^') {
+		negate = 1;
+		++parser->p;
+	}
+	/* a leading ']' is a literal */
+	int first = 1;
+	while (*parser->p && (first || *parser->p != ']')) {
+		first = 0;
+		unsigned char c = *parser->p;
+		if (c == '[' && parser->p[1] == ':') {
+			const char *name = parser->p + 2;
+			const char *end = strstr(name, ":]");
+			if (!end || add_char_class(&set, name, end - name)) {
+				parser->error = 1;
+				break;
+			}
+			parser->p = end + 2;
+			continue;
+		} else if (c == '[' &&
+			   (parser->p[1] == '.' || parser->p[1] == '=')) {
+			/* collating elements and equivalence classes */
+			parser->error = 1;
+			break;
+		}
+		++parser->p;
+		if (*parser->p == '-' && parser->p[1] && parser->p[1] != ']') {
+			unsigned char last = parser->p[1];
+			if (last < c || last == '[') {
+				parser->error = 1;
+				break;
+			}
+			for (int i = c; i <= last; ++i)
+				SET_ADD(&set, i);
+			parser->p += 2;
+		} else {
+			SET_ADD(&set, c);
+		}
+	}
+	if (*parser->p != ']')
+		parser->error = 1;
+	else
+		++parser->p;
+	if (negate) {
+		for (int i = 0; i < 32; ++i)
+			set.bits[i] = ~set.bits[i];
+	}
+	return byte_set_fragment(parser->nfa, &set);
+}
+
+static Fragment parse_escape(Regex_Parser *parser)
+{
+	Byte_Set set;
+	unsigned char c = *parser->p;
+	memset(&set, 0, sizeof(set));
+	if (!c) {
+		parser->error = 1;
+		return single(parser->nfa, NFA_EPSILON, -1);
+	}
+	++parser->p;
+	if (c == 'b')
+		return single(parser->nfa, NFA_BOUNDARY, -1);
+	if (c == 'w' || c == 'W' || c == 's' || c == 'S') {
+		for (int i = 0; i < 256; ++i) {
+			int member = (c == 'w' || c == 'W')
+					 ? is_word_byte(i)
+					 : i == ' ' || (i >= '\t' && i <= '\r');
+			if (member == (c == 'w' || c == 's'))
+				SET_ADD(&set, i);
+		}
+		return byte_set_fragment(parser->nfa, &set);
+	}
+	/* back-references, `\B`, `\<`, `\>` and the like are left to regex */
+	if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+	    (c >= '0' && c <= '9') || c == '<' || c == '>' || c == '`' ||
+	    c == '\'') {
+		parser->error = 1;
+		return single(parser->nfa, NFA_EPSILON, -1);
+	}
+	SET_ADD(&set, c);
+	return byte_set_fragment(parser->nfa, &set);
+}
+
+static Fragment parse_alternation(Regex_Parser *parser);
+
+static Fragment parse_atom(Regex_Parser *parser)
+{
+	Byte_Set set;
+	unsigned char c = *parser->p;
+	memset(&set, 0, sizeof(set));
+	switch (c) {
+	case '(': {
+		++parser->p;
+		Fragment fragment = parse_alternation(parser);
+		if (*parser->p != ')')
+			parser->error = 1;
+		else
+			++parser->p;
+		return fragment;
+	}
+	case '[':
+		++parser->p;
+		return parse_bracket(parser);
+	case '\\':
+		++parser->p;
+		return parse_escape(parser);
+	case '.':
+		++parser->p;
+		/* '.' matches anything but NUL (RE_DOT_NOT_NULL) */
+		for (int i = 1; i < 256; ++i)
+			SET_ADD(&set, i);
+		return byte_set_fragment(parser->nfa, &set);
+	case '^':
+	case '$':
+	case '{':
+	case ')':
+	case '*':
+	case '+':
+	case '?':
+	case '|':
+	case '\0':
+		/* anchors, intervals and misplaced operators */
+		parser->error = 1;
+		return single(parser->nfa, NFA_EPSILON, -1);
+	default:
+		++parser->p;
+		SET_ADD(&set, c);
+		return byte_set_fragment(parser->nfa, &set);
+	}
+}
+
+static Fragment parse_repeat(Regex_Parser *parser)
+{
+	Nfa *nfa = parser->nfa;
+	Fragment fragment = parse_atom(parser);
+	while (*parser->p == '*' || *parser->p == '+' || *parser->p == '?') {
+		int split = add_node(nfa, NFA_SPLIT);
+		int end = add_node(nfa, NFA_EPSILON);
+		nfa->nodes[split].out = fragment.start;
+		nfa->nodes[split].out1 = end;
+		if (*parser->p == '?')
+			nfa->nodes[fragment.end].out = end;
+		else
+			nfa->nodes[fragment.end].out = split;
+		/* '+' has to go through the fragment at least once */
+		if (*parser->p != '+')
+			fragment.start = split;
+		fragment.end = end;
+		++parser->p;
+	}
+	if (*parser->p == '{')
+		parser->error = 1;
+	return fragment;
+}
+
+static Fragment parse_concatenation(Regex_Parser *parser)
+{
+	Fragment fragment = parse_repeat(parser);
+	while (!parser->error && *parser->p && *parser->p != '|' &&
+	       *parser->p != ')') {
+		Fragment next = parse_repeat(parser);
+		parser->nfa->nodes[fragment.end].out = next.start;
+		fragment.end = next.end;
+	}
+	return fragment;
+}
+
+static Fragment parse_alternation(Regex_Parser *parser)
+{
+	Nfa *nfa = parser->nfa;
+	Fragment fragment = parse_concatenation(parser);
+	while (!parser->error && *parser->p == '|') {
+		++parser->p;
+		Fragment next = parse_concatenation(parser);
+		int split = add_node(nfa, NFA_SPLIT);
+		int end = add_node(nfa, NFA_EPSILON);
+		nfa->nodes[split].out = fragment.start;
+		nfa->nodes[split].out1 = next.start;
+		nfa->nodes[fragment.end].out = end;
+		nfa->nodes[next.end].out = end;
+		fragment.start = split;
+		fragment.end = end;
+	}
+	return fragment;
+}
+
+/* compile a pattern into the NFA, returns the entry node or -1 */
+static int compile_pattern(Nfa *nfa, const char *pattern, int token)
+{
+	Regex_Parser parser;
+	parser.p = pattern;
+	parser.nfa = nfa;
+	parser.error = 0;
+	Fragment fragment = parse_alternation(&parser);
+	if (parser.error || *parser.p)
+		return -1;
+	int match = add_node(nfa, NFA_MATCH);
+	nfa->nodes[match].token = token;
+	nfa->nodes[fragment.end].out = match;
+	return fragment.start;
+}
+
+static void clean_nfa(Nfa *nfa)
+{
+	free(nfa->nodes);
+	free(nfa->sets);
+	memset(nfa, 0, sizeof(Nfa));
+}
+
+int dfa_is_supported(const char *pattern)
+{
+	Nfa nfa;
+	memset(&nfa, 0, sizeof(nfa));
+	int start = compile_pattern(&nfa, pattern, 0);
+	clean_nfa(&nfa);
+	return start >= 0;
+}
+
+/**
+ * struct closure (Closure) - the epsilon closure of a set of NFA nodes.
+ * @sets:	the NFA_SET nodes reached
+ * @set_count:	number of NFA_SET nodes reached
+ * @token:	the lowest token index of the NFA_MATCH nodes reached
+ */
+typedef struct closure {
+	int *sets;
+	int set_count;
+	int token;
+} Closure;
+
+/**
+ * struct subset_builder (Subset_Builder) - state of the subset construction.
+ * @nfa:		the NFA
+ * @kernels:		for each DFA state, the NFA nodes it stands for
+ * @kernel_lengths:	for each DFA state, the number of NFA nodes
+ * @prev_word:		for each DFA state, boolean indicates if it was
+ * 			entered with a word character
+ * @state_count:	number of DFA states
+ * @mark:		visit mark of each NFA node for the closure traversal
+ * @generation:		the current visit mark
+ * @stack:		traversal stack for the closure
+ */
+typedef struct subset_builder {
+	Nfa *nfa;
+	int **kernels;
+	int *kernel_lengths;
+	int *prev_word;
+	int state_count;
+	int *mark;
+	int generation;
+	int *stack;
+} Subset_Builder;
+
+static void compute_closure(Subset_Builder *builder, int state, int next_word,
+			    Closure *closure)
+{
+	Nfa_Node *nodes = builder->nfa->nodes;
+	int *kernel = builder->kernels[state];
+	int stack_size = 0;
+	/* `\b` holds when the previous and next characters differ in kind */
+	int boundary = builder->prev_word[state] != next_word;
+	++builder->generation;
+	closure->set_count = 0;
+	closure->token = DFA_NONE;
+	for (int i = 0; i < builder->kernel_lengths[state]; ++i) {
+		builder->stack[stack_size++] = kernel[i];
+		builder->mark[kernel[i]] = builder->generation;
+	}
+	while (stack_size) {
+		int id = builder->stack[--stack_size];
+		int outs[2] = {-1, -1};
+		switch (nodes[id].type) {
+		case NFA_EPSILON:
+			outs[0] = nodes[id].out;
+			break;
+		case NFA_SPLIT:
+			outs[0] = nodes[id].out;
+			outs[1] = nodes[id].out1;
+			break;
+		case NFA_BOUNDARY:
+			if (boundary)
+				outs[0] = nodes[id].out;
+			break;
+		case NFA_SET:
+			closure->sets[closure->set_count++] = id;
+			break;
+		case NFA_MATCH:
+			if (closure->token == DFA_NONE ||
+			    nodes[id].token < closure->token)
+				closure->token = nodes[id].token;
+			break;
+		}
+		for (int i = 0; i < 2; ++i) {
+			if (outs[i] >= 0 &&
+			    builder->mark[outs[i]] != builder->generation) {
+				builder->mark[outs[i]] = builder->generation;
+				builder->stack[stack_size++] = outs[i];
+			}
+		}
+	}
+}
+
+/* check if a `\b` can be reached from the NFA nodes of a kernel, otherwise
+ * the kind of the previous character does not matter to its state */
+static int reaches_boundary(Subset_Builder *builder, int *kernel, int length)
+{
+	Nfa_Node *nodes = builder->nfa->nodes;
+	int stack_size = 0;
+	++builder->generation;
+	for (int i = 0; i < length; ++i) {
+		builder->stack[stack_size++] = kernel[i];
+		builder->mark[kernel[i]] = builder->generation;
+	}
+	while (stack_size) {
+		int id = builder->stack[--stack_size];
+		int outs[2] = {-1, -1};
+		if (nodes[id].type == NFA_BOUNDARY)
+			return 1;
+		if (nodes[id].type == NFA_EPSILON ||
+		    nodes[id].type == NFA_SPLIT)
+			outs[0] = nodes[id].out;
+		if (nodes[id].type == NFA_SPLIT)
+			outs[1] = nodes[id].out1;
+		for (int i = 0; i < 2; ++i) {
+			if (outs[i] >= 0 &&
+			    builder->mark[outs[i]] != builder->generation) {
+				builder->mark[outs[i]] = builder->generation;
+				builder->stack[stack_size++] = outs[i];
+			}
+		}
+	}
+	return 0;
+}
+
+static int compare_int(const void *a, const void *b)
+{
+	return *(const int *)a - *(const int *)b;
+}
+
+/* find the DFA state of a kernel, creating it if needed */
+static int find_state(Subset_Builder *builder, int *kernel, int length,
+		      int prev_word)
+{
+	for (int i = 0; i < builder->state_count; ++i) {
+		if (builder->kernel_lengths[i] == length &&
+		    builder->prev_word[i] == prev_word &&
+		    !memcmp(builder->kernels[i], kernel, length * sizeof(int)))
+			return i;
+	}
+	if (builder->state_count == DFA_MAX_STATES)
+		return -1;
+	int state = builder->state_count++;
+	builder->kernels[state] = (int *)malloc(length * sizeof(int) + 1);
+	memcpy(builder->kernels[state], kernel, length * sizeof(int));
+	builder->kernel_lengths[state] = length;
+	builder->prev_word[state] = prev_word;
+	return state;
+}
+
+/* find the set of bytes each state loops on, a set being only kept if it is
+ * exactly the bytes leading back to the state and if the state accepts the
+ * same token (or none) whichever of them comes next */
+static unsigned char *find_loop_sets(int state_count, int class_count,
+				     const unsigned char *byte_class,
+				     const int16_t *next, const int16_t *accept)
+{
+	unsigned char *loop_set = (unsigned char *)malloc(state_count);
+	for (int state = 0; state < state_count; ++state) {
+		loop_set[state] = SCAN_NONE;
+		for (int set = SCAN_NONE + 1; set < SCAN_SET_COUNT; ++set) {
+			int fits = 1;
+			int has_token = 0;
+			int token = DFA_NONE;
+			for (int c = 0; fits && c < 256; ++c) {
+				int index = state * class_count + byte_class[c];
+				int loops = next[index] == state;
+				if (loops != scan_has(set, c)) {
+					fits = 0;
+				} else if (loops && !has_token) {
+					token = accept[index];
+					has_token = 1;
+				} else if (loops && accept[index] != token) {
+					fits = 0;
+				}
+			}
+			if (fits) {
+				loop_set[state] = set;
+				break;
+			}
+		}
+	}
+	return loop_set;
+}
+
+int dfa_build(Dfa *dfa, char **patterns, int count, const int *use_dfa)
+{
+	int return_value = 0;
+	Nfa nfa;
+	memset(&nfa, 0, sizeof(nfa));
+	memset(dfa, 0, sizeof(Dfa));
+
+	/* the start state stands for the entry nodes of all the patterns */
+	int *starts = (int *)malloc((count + 1) * sizeof(int));
+	int start_count = 0;
+	for (int i = 0; i < count; ++i) {
+		if (!use_dfa[i])
+			continue;
+		int start = compile_pattern(&nfa, patterns[i], i);
+		if (start >= 0)
+			starts[start_count++] = start;
+	}
+
+	/* split the bytes into classes that no set and no `\b` can tell apart
+	 */
+	unsigned char *byte_class = (unsigned char *)malloc(256);
+	int representatives[256];
+	int class_count = 0;
+	for (int c = 0; c < 256; ++c) {
+		int class = 0;
+		for (; class < class_count; ++class) {
+			int r = representatives[class];
+			int same = is_word_byte(c) == is_word_byte(r);
+			for (int i = 0; same && i < nfa.set_count; ++i)
+				same = !SET_HAS(nfa.sets + i, c) ==
+				       !SET_HAS(nfa.sets + i, r);
+			if (same)
+				break;
+		}
+		if (class == class_count)
+			representatives[class_count++] = c;
+		byte_class[c] = class;
+	}
+	/* the extra class stands for the end of the input */
+	int end_class = class_count++;
+
+	Subset_Builder builder;
+	builder.nfa = &nfa;
+	builder.kernels = (int **)malloc(DFA_MAX_STATES * sizeof(int *));
+	builder.kernel_lengths = (int *)malloc(DFA_MAX_STATES * sizeof(int));
+	builder.prev_word = (int *)malloc(DFA_MAX_STATES * sizeof(int));
+	builder.state_count = 0;
+	builder.mark = (int *)calloc(nfa.node_count + 1, sizeof(int));
+	builder.generation = 0;
+	builder.stack = (int *)malloc((nfa.node_count + 1) * sizeof(int));
+	qsort(starts, start_count, sizeof(int), compare_int);
+	find_state(&builder, starts, start_count, 0);
+
+	Closure closures[2];
+	for (int i = 0; i < 2; ++i)
+		closures[i].sets =
+		    (int *)malloc((nfa.node_count + 1) * sizeof(int));
+	int *kernel = (int *)malloc((nfa.node_count + 1) * sizeof(int));
+	int16_t *next = NULL;
+	int16_t *accept = NULL;
+	/* states are appended while the table is being filled */
+	for (int state = 0; state < builder.state_count; ++state) {
+		next = (int16_t *)realloc(next, (state + 1) * class_count *
+						    sizeof(int16_t));
+		accept = (int16_t *)realloc(accept, (state + 1) * class_count *
+							sizeof(int16_t));
+		for (int i = 0; i < 2; ++i)
+			compute_closure(&builder, state, i, closures + i);
+		for (int class = 0; class < class_count; ++class) {
+			int index = state * class_count + class;
+			int c = class == end_class ? -1 : representatives[class];
+			Closure *closure = closures + (c >= 0 && is_word_byte(c));
+			accept[index] = closure->token;
+			next[index] = DFA_NONE;
+			if (c < 0)
+				continue;
+			int length = 0;
+			for (int i = 0; i < closure->set_count; ++i) {
+				Nfa_Node *node = nfa.nodes + closure->sets[i];
+				if (SET_HAS(nfa.sets + node->set, c))
+					kernel[length++] = node->out;
+			}
+			if (!length)
+				continue;
+			qsort(kernel, length, sizeof(int), compare_int);
+			int unique = 1;
+			for (int i = 1; i < length; ++i) {
+				if (kernel[i] != kernel[unique - 1])
+					kernel[unique++] = kernel[i];
+			}
+			int target = find_state(
+			    &builder, kernel, unique,
+			    is_word_byte(c) &&
+				reaches_boundary(&builder, kernel, unique));
+			if (target < 0) {
+				return_value = -1;
+				break;
+			}
+			next[index] = target;
+		}
+		if (return_value)
+			break;
+	}
+
+	if (!return_value) {
+		dfa->state_count = builder.state_count;
+		dfa->class_count = class_count;
+		dfa->byte_class = byte_class;
+		dfa->next = next;
+		dfa->accept = accept;
+		dfa->loop_set =
+		    find_loop_sets(builder.state_count, class_count, byte_class,
+				   next, accept);
+	} else {
+		free(byte_class);
+		free(next);
+		free(accept);
+	}
+
+	/* cleanup */
+	for (int i = 0; i < builder.state_count; ++i)
+		free(builder.kernels[i]);
+	free(builder.kernels);
+	free(builder.kernel_lengths);
+	free(builder.prev_word);
+	free(builder.mark);
+	free(builder.stack);
+	for (int i = 0; i < 2; ++i)
+		free(closures[i].sets);
+	free(kernel);
+	free(starts);
+	clean_nfa(&nfa);
+	return return_value;
+}
+
+int dfa_match(const Dfa *dfa, const char *value, size_t length, int *token)
+{
+	int class_count = dfa->class_count;
+	int state = 0;
+	int best_token = DFA_NONE;
+	int best_end = 0;
+	for (size_t i = 0;; ++i) {
+		int class = i < length
+				? dfa->byte_class[(unsigned char)value[i]]
+				: class_count - 1;
+		int index = state * class_count + class;
+		int accepted = dfa->accept[index];
+		/* a token of higher precedence always wins, the same token
+		 * extends its match (longest match), empty matches do not
+		 * count */
+		if (accepted != DFA_NONE && i &&
+		    (best_token == DFA_NONE || accepted <= best_token)) {
+			best_token = accepted;
+			best_end = i;
+		}
+		int next_state;
+		if (i == length || (next_state = dfa->next[index]) == DFA_NONE)
+			break;
+		/* the state loops on the byte, if the next one loops too, the
+		 * rest of the run is skipped at once, accepting the same token
+		 * all along */
+		if (next_state == state && dfa->loop_set[state] != SCAN_NONE &&
+		    i + 1 < length &&
+		    dfa->next[state * class_count +
+			      dfa->byte_class[(unsigned char)value[i + 1]]] ==
+			state) {
+			i += scan_run(dfa->loop_set[state], value + i + 1,
+				      length - i - 1);
+			if (accepted != DFA_NONE &&
+			    (best_token == DFA_NONE || accepted <= best_token)) {
+				best_token = accepted;
+				best_end = i;
+			}
+		}
+		state = next_state;
+	}
+	*token = best_token;
+	return best_end;
+}
+
+void dfa_first_tokens(const Dfa *dfa, int16_t *tokens)
+{
+	int class_count = dfa->class_count;
+	int16_t *lowest =
+	    (int16_t *)malloc(dfa->state_count * sizeof(int16_t));
+	/* the first token accepted from each state on, up to a fixed point */
+	for (int state = 0; state < dfa->state_count; ++state) {
+		lowest[state] = INT16_MAX;
+		for (int class = 0; class < class_count; ++class) {
+			int accepted = dfa->accept[state * class_count + class];
+			if (accepted != DFA_NONE && accepted < lowest[state])
+				lowest[state] = accepted;
+		}
+	}
+	for (int is_changed = 1; is_changed;) {
+		is_changed = 0;
+		for (int state = 0; state < dfa->state_count; ++state) {
+			for (int class = 0; class < class_count; ++class) {
+				int next = dfa->next[state * class_count + class];
+				if (next != DFA_NONE &&
+				    lowest[next] < lowest[state]) {
+					lowest[state] = lowest[next];
+					is_changed = 1;
+				}
+			}
+		}
+	}
+	/* empty matches do not count, the first byte is always taken */
+	for (int c = 0; c < 256; ++c) {
+		int next = dfa->next[dfa->byte_class[c]];
+		tokens[c] = next == DFA_NONE || lowest[next] == INT16_MAX
+				? DFA_NONE
+				: lowest[next];
+	}
+	free(lowest);
+}
+
+void dfa_free(Dfa *dfa)
+{
+	free((void *)dfa->byte_class);
+	free((void *)dfa->next);
+	free((void *)dfa->accept);
+	free((void *)dfa->loop_set);
+	memset(dfa, 0, sizeof(Dfa));
+}
@@ -0,0 +1,90 @@
+#ifndef DFA_H
+#define DFA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* maximum number of states a combined token DFA may have before the builder
+ * gives up and leaves every token to its regex */
+#define DFA_MAX_STATES 4096
+
+/* marks the absence of a transition or of an accepting token */
+#define DFA_NONE -1
+
+/**
+ * struct dfa (Dfa) - deterministic automaton matching all the token patterns at
+ * once (anchored at the start of the input).
+ * @state_count:	number of states, state 0 is the start state
+ * @class_count:	number of input classes, the last one being the end of
+ * 			input class
+ * @byte_class:		map a byte to its input class
+ * @next:		transition table indexed by state * class_count + class
+ * @accept:		accepting table indexed by state * class_count + class,
+ * 			the index of the first token matching when the next
+ * 			input is of the given class, or DFA_NONE
+ * @loop_set:		for each state, the &enum scan_set of the bytes leading
+ * 			back to the state while accepting the same token, or
+ * 			SCAN_NONE, such runs being skipped at once by
+ * 			dfa_match() (e.g. the rest of an identifier)
+ *
+ * Since `\b` depends on the next character, acceptance is decided when the
+ * next input class is known, hence @accept being indexed by class as well.
+ */
+typedef struct dfa {
+	int state_count;
+	int class_count;
+	const unsigned char *byte_class;
+	const int16_t *next;
+	const int16_t *accept;
+	const unsigned char *loop_set;
+} Dfa;
+
+/**
+ * dfa_is_supported() - check if a pattern can be compiled into the DFA.
+ * @pattern:	POSIX extended regex pattern
+ *
+ * Return: 	0: the pattern must be matched with regex
+ * 		1: the pattern can be compiled into the DFA
+ */
+int dfa_is_supported(const char *pattern);
+
+/**
+ * dfa_build() - compile the supported patterns into a single DFA.
+ * @dfa:	the &Dfa to be built
+ * @patterns:	list of patterns, in order of precedence
+ * @count:	the number of patterns
+ * @use_dfa:	for each pattern, boolean indicates if it has to be compiled,
+ * 		the ones left out never match
+ *
+ * Return: 	0: success
+ * 		-1: the DFA would have more than DFA_MAX_STATES states
+ */
+int dfa_build(Dfa *dfa, char **patterns, int count, const int *use_dfa);
+
+/**
+ * dfa_match() - find the first token (in order of precedence) whose pattern
+ * matches the beginning of the input, and its longest match.
+ * @dfa:	the compiled &Dfa
+ * @value:	the input to be matched
+ * @length:	the length of the input
+ * @token:	the index of the matching token, or DFA_NONE
+ *
+ * Return: 	the ending position of the match (0 if nothing matches)
+ */
+int dfa_match(const Dfa *dfa, const char *value, size_t length, int *token);
+
+/**
+ * dfa_first_tokens() - find, for each first byte of the input, the first token
+ * (in order of precedence) the DFA could match.
+ * @dfa:	the compiled &Dfa
+ * @tokens:	for each of the 256 bytes, the index of the token, or DFA_NONE
+ */
+void dfa_first_tokens(const Dfa *dfa, int16_t *tokens);
+
+/**
+ * dfa_free() - cleanup the tables of a DFA built by dfa_build().
+ * @dfa:	the &Dfa
+ */
+void dfa_free(Dfa *dfa);
+
+#endif /* DFA_H */
@@ -0,0 +1,34 @@
+#include "events.h"
+#include "ast.h"
+#include "output.h"
+#include "token_table.h"
+
+static void print_enter(void *user_data, int non_terminal, int line,
+			int column)
+{
+	output_printf((Output *)user_data, "enter %s [%d:%d]\n",
+		      non_terminal_names[non_terminal], line, column);
+}
+
+static void print_exit(void *user_data, int non_terminal, int line,
+		       int column)
+{
+	output_printf((Output *)user_data, "exit %s [%d:%d]\n",
+		      non_terminal_names[non_terminal], line, column);
+}
+
+static void print_terminal(void *user_data, int kind, const char *lexeme,
+			   int length, int line, int column)
+{
+	output_printf((Output *)user_data, "terminal %s '%.*s' [%d:%d-%d]\n",
+		      token_kind_names[kind], length, lexeme, line, column,
+		      column + length);
+}
+
+void init_printed_events(Parse_Events *events, Output *out)
+{
+	events->enter = print_enter;
+	events->exit = print_exit;
+	events->terminal = print_terminal;
+	events->user_data = out;
+}
@@ -0,0 +1,53 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include "output.h"
+
+/*
+ * Callbacks of the syntax analysis, for the consumers which only need to
+ * follow it (e.g. "entered <while statement> at line L", "saw variable X")
+ * rather than to get its whole AST. The syntax analyzer calls them as it
+ * enters and exits each non-terminal and consumes each terminal, keeping
+ * nothing of what it reported, so that a pass over an input of any size
+ * only needs memory for the nesting of the input (unless the AST is built or
+ * the input is lexed first with --lex-first).
+ *
+ * The positions are the ones of the messages: the lines and columns are
+ * counted from 1, a tab counting as TAB_SIZE columns.
+ */
+
+/**
+ * struct parse_events (Parse_Events) - the callbacks, any of which can be
+ * NULL.
+ * @enter:	called on entering a non-terminal (see &enum non_terminal),
+ * 		at the position of the current token (where it starts), or
+ * 		of the start of the input for <program>
+ * @exit:	called on exiting a non-terminal, at the position of the
+ * 		current token (the one following it, or the end of the
+ * 		input), but not for the non-terminals still being parsed
+ * 		when the input ends unexpectedly or junk follows the program
+ * @terminal:	called when a token is consumed, with its kind (see &enum
+ * 		token_kind), its lexeme (in the input, not NUL-terminated)
+ * 		and its position
+ * @user_data:	passed to each callback
+ *
+ * The tokens skipped by the panic-mode recovery, or left after the end of
+ * the program, are not consumed.
+ */
+typedef struct parse_events {
+	void (*enter)(void *user_data, int non_terminal, int line, int column);
+	void (*exit)(void *user_data, int non_terminal, int line, int column);
+	void (*terminal)(void *user_data, int kind, const char *lexeme,
+			 int length, int line, int column);
+	void *user_data;
+} Parse_Events;
+
+/**
+ * init_printed_events() - set up callbacks printing each event as a line
+ * (--events).
+ * @events:	the &Parse_Events
+ * @out:	the &Output the events are printed to
+ */
+void init_printed_events(Parse_Events *events, Output *out);
+
+#endif /* EVENTS_H */
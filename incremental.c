@@ -0,0 +1,554 @@
+#include "incremental.h"
+#include "parse_error.h"
+#include "setting.h"
+#include "syntax.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * The lines are kept in a gap buffer whose gap is moved to the edited lines,
+ * so an edit costs the distance from the previous one instead of the size of
+ * the document. The start of the lines after the gap is kept relative to the
+ * end of the document so that it does not change when the length does.
+ */
+
+static Doc_Line *get_line(Document *document, size_t index)
+{
+	if (index >= document->gap_start)
+		index += document->gap_length;
+	return document->lines + index;
+}
+
+static size_t get_line_start(Document *document, size_t index)
+{
+	Doc_Line *line = get_line(document, index);
+	if (index >= document->gap_start)
+		return line->start + document->length;
+	return line->start;
+}
+
+static void move_gap(Document *document, size_t position)
+{
+	Doc_Line *lines = document->lines;
+	while (document->gap_start > position) {
+		Doc_Line *line = lines + --document->gap_start;
+		line->start -= document->length;
+		lines[document->gap_start + document->gap_length] = *line;
+	}
+	while (document->gap_start < position) {
+		Doc_Line *line =
+		    lines + document->gap_start + document->gap_length;
+		line->start += document->length;
+		lines[document->gap_start++] = *line;
+	}
+}
+
+static void reserve_lines(Document *document, size_t count)
+{
+	if (document->gap_length >= count)
+		return;
+	size_t after = document->line_count - document->gap_start;
+	size_t capacity = document->line_capacity * 2 + count + 1024;
+	Doc_Line *lines = (Doc_Line *)malloc(capacity * sizeof(Doc_Line));
+	if (document->lines) {
+		memcpy(lines, document->lines,
+		       document->gap_start * sizeof(Doc_Line));
+		memcpy(lines + capacity - after,
+		       document->lines + document->gap_start +
+			   document->gap_length,
+		       after * sizeof(Doc_Line));
+		free(document->lines);
+	}
+	document->lines = lines;
+	document->line_capacity = capacity;
+	document->gap_length = capacity - document->line_count;
+}
+
+/* find the line containing a position, the last line for the end of the
+ * document */
+static size_t find_line(Document *document, size_t position)
+{
+	size_t low = 0, high = document->line_count;
+	while (high - low > 1) {
+		size_t middle = low + (high - low) / 2;
+		if (get_line_start(document, middle) <= position)
+			low = middle;
+		else
+			high = middle;
+	}
+	return low;
+}
+
+/* allocate in the arena of the document, counting what it holds */
+static void *document_alloc(Document *document, size_t size)
+{
+	document->allocated += size;
+	return arena_alloc(&document->arena, size);
+}
+
+static char *document_strdup(Document *document, const char *value)
+{
+	size_t length = strlen(value);
+	document->allocated += length + 1;
+	return arena_strndup(&document->arena, value, length);
+}
+
+/* lex a line on its own with the lexer context, which collects the lexical
+ * errors */
+static void lex_line(Document *document, Doc_Line *line)
+{
+	Parse_Context *context = &document->lexer_context;
+	Lexer *lexer = &context->lexer;
+	lexer->input.content = line->text;
+	lexer->input.length = line->length;
+	lexer->cursor = 0;
+	lexer->line_end = 0;
+	lexer->line_number = 0;
+	lexer->col_number = 0;
+	start_line(lexer);
+
+	int token_count = 0, error_count = 0;
+	Lex_Token *lex_token;
+	do {
+		Parse_Error *last_error = context->error_tail;
+		lex_token = lex(context);
+		/* the errors found on the way come before the token */
+		for (Parse_Error *error =
+			 last_error ? last_error->next : context->error_list;
+		     error; error = error->next) {
+			if (error_count == document->lex_error_capacity) {
+				document->lex_error_capacity =
+				    document->lex_error_capacity * 2 + 16;
+				document->lex_errors = (Doc_Lex_Error *)realloc(
+				    document->lex_errors,
+				    document->lex_error_capacity *
+					sizeof(Doc_Lex_Error));
+			}
+			Doc_Lex_Error *lex_error =
+			    document->lex_errors + error_count++;
+			lex_error->before = token_count;
+			lex_error->start_col = error->start_col;
+			lex_error->end_col = error->end_col;
+			lex_error->id = error->id;
+			lex_error->message =
+			    document_strdup(document, error->message);
+		}
+		if (!lex_token)
+			break;
+		if (token_count == document->token_capacity) {
+			document->token_capacity =
+			    document->token_capacity * 2 + 256;
+			document->tokens = (Doc_Token *)realloc(
+			    document->tokens,
+			    document->token_capacity * sizeof(Doc_Token));
+		}
+		Doc_Token *token = document->tokens + token_count++;
+		token->token = lex_token->token;
+		token->offset = lex_token->offset;
+		token->length = lex_token->length;
+		token->end_col = lexer->col_number;
+		token->block = NULL;
+	} while (1);
+	line->end_col = lexer->col_number;
+
+	line->token_count = token_count;
+	line->tokens = (Doc_Token *)document_alloc(
+	    document, token_count * sizeof(Doc_Token));
+	if (token_count)
+		memcpy(line->tokens, document->tokens,
+		       token_count * sizeof(Doc_Token));
+	line->error_count = error_count;
+	line->errors = NULL;
+	if (error_count) {
+		line->errors = (Doc_Lex_Error *)document_alloc(
+		    document, error_count * sizeof(Doc_Lex_Error));
+		memcpy(line->errors, document->lex_errors,
+		       error_count * sizeof(Doc_Lex_Error));
+		clean_error_list(context);
+	}
+	/* the messages are not wanted, only the errors */
+	context->out.length = 0;
+}
+
+/* split a text into lines, lex them and insert them at the gap */
+static size_t insert_lines(Document *document, const char *text, size_t length,
+			   size_t start)
+{
+	size_t count = 0;
+	for (size_t position = 0; position < length; ++count) {
+		const char *newline = (const char *)memchr(
+		    text + position, '\n', length - position);
+		size_t end = newline ? (size_t)(newline - text) + 1 : length;
+		reserve_lines(document, 1);
+		Doc_Line *line = document->lines + document->gap_start++;
+		--document->gap_length;
+		++document->line_count;
+		line->start = start + position;
+		line->text = text + position;
+		line->length = end - position;
+		lex_line(document, line);
+		position = end;
+	}
+	return count;
+}
+
+Document *create_document(void)
+{
+	Document *document = (Document *)calloc(1, sizeof(Document));
+	Parse_Options options = {.format = OUTPUT_TEXT,
+				 .ast_mode = AST_MODE_NONE,
+				 .context_lines = -1};
+	init_context(&document->context, &options, NULL);
+	init_context(&document->lexer_context, &options, NULL);
+	document->context.document = document;
+	init_arena(&document->arena);
+	init_arena(&document->result_arena);
+	return document;
+}
+
+static void add_item(Document *document, Block_Item *item)
+{
+	if (document->item_count == document->item_capacity) {
+		document->item_capacity = document->item_capacity * 2 + 64;
+		document->items = (Block_Item *)realloc(
+		    document->items,
+		    document->item_capacity * sizeof(Block_Item));
+	}
+	document->items[document->item_count++] = *item;
+}
+
+/**
+ * struct item_walk (Item_Walk) - a list of items being walked through.
+ * @items:	the items
+ * @count:	the number of items
+ * @index:	index of the next item
+ * @line:	the line the lines of the items are relative to
+ */
+typedef struct item_walk {
+	Block_Item *items;
+	int count;
+	int index;
+	int line;
+} Item_Walk;
+
+/* build the error list from the items of the whole document */
+static void collect_errors(Document *document)
+{
+	Parse_Error **next = &document->errors;
+	int capacity = 64, depth = 1;
+	Item_Walk *walks = (Item_Walk *)malloc(capacity * sizeof(Item_Walk));
+	walks[0] = (Item_Walk){document->items, document->item_count, 0, 0};
+	document->error_count = 0;
+	while (depth) {
+		Item_Walk *walk = walks + depth - 1;
+		if (walk->index == walk->count) {
+			--depth;
+			continue;
+		}
+		Block_Item *item = walk->items + walk->index++;
+		int line = walk->line + item->line;
+		if (item->block) {
+			if (depth == capacity) {
+				capacity *= 2;
+				walks = (Item_Walk *)realloc(
+				    walks, capacity * sizeof(Item_Walk));
+			}
+			walks[depth++] =
+			    (Item_Walk){item->block->items,
+					item->block->item_count, 0, line};
+			continue;
+		}
+		Parse_Error *error = (Parse_Error *)arena_alloc(
+		    &document->result_arena, sizeof(Parse_Error));
+		error->line_number = line + 1;
+		error->start_col = item->start_col;
+		error->end_col = item->end_col;
+		error->id = item->id;
+		error->expected = item->expected;
+		error->message = (char *)item->message;
+		*next = error;
+		next = &error->next;
+		++document->error_count;
+	}
+	*next = NULL;
+	free(walks);
+}
+
+/* the tokens a parse does not get to (after junk following the end of the
+ * program) keep the blocks of an older parse, which the edits since then may
+ * have made wrong */
+static void drop_unparsed_blocks(Document *document)
+{
+	for (size_t index = document->line; index < document->line_count;
+	     ++index) {
+		Doc_Line *line = get_line(document, index);
+		int token = index == document->line ? document->token : 0;
+		for (; token < line->token_count; ++token)
+			line->tokens[token].block = NULL;
+	}
+}
+
+/* parse the document, reusing the <compound_statement>s of the last parse
+ * outside of the damaged lines */
+static int parse_document(Document *document)
+{
+	Parse_Context *context = &document->context;
+	context->lex_token = NULL;
+	context->error_junk_after_program_end = 0;
+	context->error_unexpected_eof = 0;
+	context->display_depth = 0;
+	document->line = 0;
+	document->token = 0;
+	document->error = 0;
+	document->current = NULL;
+	document->current_block = NULL;
+	document->depth = 0;
+	document->item_count = 0;
+	reset_arena(&document->result_arena);
+
+	program(context);
+	drop_unparsed_blocks(document);
+	/* the <compound_statement>s left open on unexpected EOF leave their
+	 * items to the enclosing ones */
+	document->depth = 0;
+	collect_errors(document);
+	return document->error_count;
+}
+
+int document_parse(Document *document, const char *content, size_t length)
+{
+	reset_arena(&document->arena);
+	document->allocated = 0;
+	document->line_count = 0;
+	document->gap_start = 0;
+	document->gap_length = document->line_capacity;
+	document->length = length;
+	char *text = (char *)document_alloc(document, length);
+	memcpy(text, content, length);
+	insert_lines(document, text, length, 0);
+	document->damage_start = 0;
+	document->damage_end = document->line_count;
+	int error_count = parse_document(document);
+	/* what the edits replace is left in the arena until it outgrows
+	 * this */
+	document->compact_size =
+	    DOCUMENT_COMPACT_RATIO * document->allocated + ARENA_BLOCK_SIZE;
+	return error_count;
+}
+
+/* parse the document from scratch, which releases what the edits left in the
+ * arena: the replaced lines with their tokens, and the blocks and messages
+ * of the previous parses */
+static int compact_document(Document *document)
+{
+	char *content = (char *)malloc(document->length + 1);
+	size_t length = 0;
+	for (size_t i = 0; i < document->line_count; ++i) {
+		Doc_Line *line = get_line(document, i);
+		memcpy(content + length, line->text, line->length);
+		length += line->length;
+	}
+	int error_count = document_parse(document, content, length);
+	free(content);
+	return error_count;
+}
+
+int document_edit(Document *document, size_t start, size_t end,
+		  const char *replacement, size_t length)
+{
+	if (start > end || end > document->length)
+		return -1;
+	/* the lines touched by the edit are replaced as a whole */
+	size_t first = 0, last = 0, region_start = 0, region_end = 0;
+	Doc_Line *first_line = NULL, *last_line = NULL;
+	if (document->line_count) {
+		first = find_line(document, start);
+		last = find_line(document, end);
+		first_line = get_line(document, first);
+		last_line = get_line(document, last);
+		region_start = get_line_start(document, first);
+		region_end = get_line_start(document, last) + last_line->length;
+	}
+	size_t prefix = start - region_start, suffix = region_end - end;
+	size_t text_length = prefix + length + suffix;
+	char *text = (char *)document_alloc(document, text_length);
+	if (prefix)
+		memcpy(text, first_line->text, prefix);
+	memcpy(text + prefix, replacement, length);
+	if (suffix)
+		memcpy(text + prefix + length,
+		       last_line->text + last_line->length - suffix, suffix);
+
+	move_gap(document, first);
+	if (document->line_count) {
+		document->gap_length += last - first + 1;
+		document->line_count -= last - first + 1;
+	}
+	document->length = document->length - (end - start) + length;
+	size_t count = insert_lines(document, text, text_length, region_start);
+	document->damage_start = first;
+	document->damage_end = first + count;
+	if (document->allocated > document->compact_size)
+		return compact_document(document);
+	return parse_document(document);
+}
+
+Parse_Error *document_errors(Document *document)
+{
+	return document->errors;
+}
+
+static Lex_Token *deliver_token(Document *document, Doc_Line *line,
+				int index)
+{
+	Doc_Token *token = line->tokens + index;
+	Lexer *lexer = &document->context.lexer;
+	/* the lexer state is what the syntax errors are located with */
+	lexer->input.content = line->text;
+	lexer->line_number = document->line + 1;
+	lexer->col_number = token->end_col;
+	document->lex_token.offset = token->offset;
+	document->lex_token.length = token->length;
+	document->lex_token.token = token->token;
+	/* the block of the token is either reused or parsed again */
+	document->current = token;
+	document->current_block = token->block;
+	token->block = NULL;
+	return &document->lex_token;
+}
+
+Lex_Token *next_document_token(Parse_Context *context)
+{
+	Document *document = context->document;
+	while (document->line < document->line_count) {
+		Doc_Line *line = get_line(document, document->line);
+		while (document->error < line->error_count &&
+		       line->errors[document->error].before <=
+			   document->token) {
+			Doc_Lex_Error *error = line->errors + document->error++;
+			add_document_error(context, error->id, 0,
+					   (char *)error->message,
+					   document->line + 1, error->start_col,
+					   error->end_col);
+		}
+		if (document->token < line->token_count)
+			return deliver_token(document, line, document->token++);
+		++document->line;
+		document->token = 0;
+		document->error = 0;
+	}
+	/* EOF is at the end of the last line */
+	context->lexer.line_number = document->line_count;
+	context->lexer.col_number =
+	    document->line_count
+		? get_line(document, document->line_count - 1)->end_col
+		: 0;
+	document->current = NULL;
+	document->current_block = NULL;
+	return NULL;
+}
+
+int reuse_block(Parse_Context *context)
+{
+	Document *document = context->document;
+	Doc_Block *block = document->current_block;
+	size_t line = document->line;
+	if (block && (line + block->line_span < document->damage_start ||
+		      line >= document->damage_end)) {
+		document->current->block = block;
+		if (block->item_count) {
+			Block_Item item = {.block = block, .line = line};
+			add_item(document, &item);
+		}
+		/* the lexical errors up to the token following the block were
+		 * emitted while parsing it */
+		document->line = line + block->line_span;
+		Doc_Line *exit_line = get_line(document, document->line);
+		document->error = 0;
+		while (document->error < exit_line->error_count &&
+		       exit_line->errors[document->error].before <=
+			   block->exit_token)
+			++document->error;
+		document->token = block->exit_token + 1;
+		context->lex_token =
+		    deliver_token(document, exit_line, block->exit_token);
+		return 1;
+	}
+	if (document->depth == document->frame_capacity) {
+		document->frame_capacity = document->frame_capacity * 2 + 64;
+		document->frames = (Block_Frame *)realloc(
+		    document->frames,
+		    document->frame_capacity * sizeof(Block_Frame));
+	}
+	Block_Frame *frame = document->frames + document->depth++;
+	frame->token = document->current;
+	frame->line = line;
+	frame->item_start = document->item_count;
+	return 0;
+}
+
+void end_block(Parse_Context *context)
+{
+	Document *document = context->document;
+	if (!document->depth)
+		return;
+	Block_Frame *frame = document->frames + --document->depth;
+	/* a block running to EOF is not worth reusing, its items go to the
+	 * enclosing block */
+	if (!context->lex_token)
+		return;
+	Doc_Block *block =
+	    (Doc_Block *)document_alloc(document, sizeof(Doc_Block));
+	block->line_span = document->line - frame->line;
+	block->exit_token = document->token - 1;
+	block->item_count = document->item_count - frame->item_start;
+	block->items = NULL;
+	if (block->item_count) {
+		block->items = (Block_Item *)document_alloc(
+		    document, block->item_count * sizeof(Block_Item));
+		for (int i = 0; i < block->item_count; ++i) {
+			block->items[i] = document->items[frame->item_start + i];
+			block->items[i].line -= frame->line;
+		}
+	}
+	document->item_count = frame->item_start;
+	frame->token->block = block;
+	if (block->item_count) {
+		Block_Item item = {.block = block, .line = frame->line};
+		add_item(document, &item);
+	}
+}
+
+void add_document_error(Parse_Context *context, int id, Token_Set expected,
+			char *message, int line_number, int start_col,
+			int end_col)
+{
+	Document *document = context->document;
+	/* the lines of the items are absolute until their block ends */
+	Block_Item item = {.block = NULL,
+			   .line = line_number - 1,
+			   .start_col = start_col,
+			   .end_col = end_col,
+			   .id = id,
+			   .expected = expected,
+			   .message = document_strdup(document, message)};
+	add_item(document, &item);
+}
+
+void free_document(Document *document)
+{
+	/* the lines belong to the arena */
+	memset(&document->context.lexer.input, 0, sizeof(Source));
+	memset(&document->lexer_context.lexer.input, 0, sizeof(Source));
+	document->context.document = NULL;
+	clean_context(&document->context);
+	clean_context(&document->lexer_context);
+	clean_arena(&document->arena);
+	clean_arena(&document->result_arena);
+	free(document->lines);
+	free(document->tokens);
+	free(document->lex_errors);
+	free(document->frames);
+	free(document->items);
+	free(document);
+}
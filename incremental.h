@@ -0,0 +1,287 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include "context.h"
+#include <stddef.h>
+
+/**
+ * struct doc_token (Doc_Token) - a token of a line of a &Document.
+ * @token:	the token the lexeme is associated with
+ * @offset:	position of the lexeme in its line
+ * @length:	length of the lexeme
+ * @end_col:	the column right after the lexeme
+ * @block:	the result of parsing a <compound_statement> starting at this
+ * 		token, kept to be reused by the next parse, or NULL
+ */
+typedef struct doc_token {
+	Token *token;
+	unsigned int offset;
+	int length;
+	int end_col;
+	struct doc_block *block;
+} Doc_Token;
+
+/**
+ * struct doc_lex_error (Doc_Lex_Error) - a lexical error of a line of a
+ * &Document.
+ * @before:	index of the token of the line the error comes before (the
+ * 		number of tokens of the line if it comes after all of them)
+ * @start_col:	the column where the error starts
+ * @end_col:	the column where the error ends
+ * @id:		the kind of error (see &enum error_id)
+ * @message:	the error message
+ */
+typedef struct doc_lex_error {
+	int before;
+	int start_col;
+	int end_col;
+	int id;
+	const char *message;
+} Doc_Lex_Error;
+
+/**
+ * struct doc_line (Doc_Line) - a line of a &Document, lexed on its own since
+ * no token spans several lines.
+ * @start:		position of the line in the document, encoded relatively
+ * 			to the end of the document for the lines after the gap
+ * @text:		the content of the line (with its newline)
+ * @length:		the length of the line
+ * @tokens:		the tokens of the line
+ * @token_count:	the number of tokens
+ * @errors:		the lexical errors of the line
+ * @error_count:	the number of lexical errors
+ * @end_col:		the column at the end of the line
+ */
+typedef struct doc_line {
+	ptrdiff_t start;
+	const char *text;
+	size_t length;
+	Doc_Token *tokens;
+	int token_count;
+	Doc_Lex_Error *errors;
+	int error_count;
+	int end_col;
+} Doc_Line;
+
+/**
+ * struct block_item (Block_Item) - an error emitted while parsing a
+ * <compound_statement>, or a nested <compound_statement> having error(s).
+ * @block:	the nested &Doc_Block, or NULL for an error
+ * @line:	the line of the error (or where the nested block starts),
+ * 		relative to where the enclosing block starts
+ * @start_col:	the column where the error starts
+ * @end_col:	the column where the error ends
+ * @id:		the kind of error (see &enum error_id)
+ * @expected:	the kinds of tokens that were expected, if any
+ * @message:	the error message
+ */
+typedef struct block_item {
+	struct doc_block *block;
+	int line;
+	int start_col;
+	int end_col;
+	int id;
+	Token_Set expected;
+	const char *message;
+} Block_Item;
+
+/**
+ * struct doc_block (Doc_Block) - the result of parsing a <compound_statement>,
+ * relative to the token it starts at so it stays valid as long as none of
+ * its lines is edited.
+ * @line_span:	the number of lines from the first token to the token
+ * 		following the <compound_statement>
+ * @exit_token:	index of the token following the <compound_statement> in
+ * 		its line
+ * @items:	the errors emitted while parsing it, in order
+ * @item_count:	the number of items
+ */
+typedef struct doc_block {
+	int line_span;
+	int exit_token;
+	Block_Item *items;
+	int item_count;
+} Doc_Block;
+
+/**
+ * struct block_frame (Block_Frame) - a <compound_statement> being parsed.
+ * @token:	the token it starts at
+ * @line:	the line it starts at
+ * @item_start:	index of its first item in &Document.items
+ */
+typedef struct block_frame {
+	Doc_Token *token;
+	int line;
+	int item_start;
+} Block_Frame;
+
+/**
+ * struct document (Document) - an input kept in memory with its tokens and
+ * the result of its last parse, so that it can be re-parsed after an edit by
+ * re-lexing only the edited lines and reusing the <compound_statement>s
+ * around them.
+ * @lines:		the lines, in a gap buffer
+ * @line_count:		the number of lines
+ * @gap_start:		the position of the gap in @lines
+ * @gap_length:		the length of the gap
+ * @line_capacity:	the allocated number of lines
+ * @tokens:		the tokens of the line being lexed
+ * @token_capacity:	the allocated number of @tokens
+ * @lex_errors:		the lexical errors of the line being lexed
+ * @lex_error_capacity:	the allocated number of @lex_errors
+ * @length:		the length of the document
+ * @arena:		holds the content, tokens and parse results, released
+ * 			by a full parse
+ * @allocated:		how much is allocated in @arena
+ * @compact_size:	how much @arena can hold before an edit parses the
+ * 			document from scratch to release what the previous
+ * 			edits replaced
+ * @context:		the &Parse_Context used for parsing
+ * @lexer_context:	the &Parse_Context used for lexing lines
+ * @lex_token:		the current token
+ * @line:		the line of the current token
+ * @token:		index of the next token in @line
+ * @error:		index of the next lexical error of @line to emit
+ * @current:		the current token
+ * @current_block:	the &Doc_Block the current token had in the last parse
+ * @damage_start:	the first line lexed again by the last edit
+ * @damage_end:		the line after the last line lexed again by the last
+ * 			edit
+ * @frames:		the <compound_statement>s being parsed
+ * @depth:		the number of @frames
+ * @frame_capacity:	the allocated number of @frames
+ * @items:		the items of the <compound_statement>s being parsed, and
+ * 			of the whole document
+ * @item_count:		the number of @items
+ * @item_capacity:	the allocated number of @items
+ * @errors:		the diagnostics of the last parse
+ * @error_count:	the number of @errors
+ * @result_arena:	holds the diagnostics of the last parse
+ */
+typedef struct document {
+	Doc_Line *lines;
+	size_t line_count;
+	size_t gap_start;
+	size_t gap_length;
+	size_t line_capacity;
+	Doc_Token *tokens;
+	int token_capacity;
+	Doc_Lex_Error *lex_errors;
+	int lex_error_capacity;
+	size_t length;
+	Arena arena;
+	size_t allocated;
+	size_t compact_size;
+	Parse_Context context;
+	Parse_Context lexer_context;
+	Lex_Token lex_token;
+	size_t line;
+	int token;
+	int error;
+	Doc_Token *current;
+	Doc_Block *current_block;
+	size_t damage_start;
+	size_t damage_end;
+	Block_Frame *frames;
+	int depth;
+	int frame_capacity;
+	Block_Item *items;
+	int item_count;
+	int item_capacity;
+	Parse_Error *errors;
+	int error_count;
+	Arena result_arena;
+} Document;
+
+/**
+ * create_document() - create an empty document.
+ *
+ * Return: 	the &Document
+ */
+Document *create_document(void);
+
+/**
+ * document_parse() - replace the content of the document and parse it from
+ * scratch.
+ * @document:	the &Document
+ * @content:	the new content
+ * @length:	the length of the content
+ *
+ * Return: 	the number of errors
+ */
+int document_parse(Document *document, const char *content, size_t length);
+
+/**
+ * document_edit() - replace a range of the content of the document and parse
+ * it again, re-lexing only the edited lines and reusing the
+ * <compound_statement>s of the last parse which do not span them. Once what
+ * the edits replaced outweighs what a full parse takes (see
+ * DOCUMENT_COMPACT_RATIO), the document is parsed from scratch instead, so
+ * that its memory stays bounded however long it is edited.
+ * @document:		the &Document
+ * @start:		the start of the range
+ * @end:		the end of the range
+ * @replacement:	the content replacing the range
+ * @length:		the length of the replacement
+ *
+ * Return: 	the number of errors, -1 if the range is out of the document
+ */
+int document_edit(Document *document, size_t start, size_t end,
+		  const char *replacement, size_t length);
+
+/**
+ * document_errors() - get the errors of the last parse, valid until the next
+ * parse.
+ * @document:	the &Document
+ *
+ * Return: 	the error list, in the order a full parse reports them
+ */
+Parse_Error *document_errors(Document *document);
+
+/**
+ * next_document_token() - get the next token of the document being parsed
+ * (used by lex() instead of lexing the input).
+ * @context:	the &Parse_Context of the document
+ *
+ * Return: 	the next token, NULL on EOF
+ */
+Lex_Token *next_document_token(Parse_Context *context);
+
+/**
+ * reuse_block() - skip the <compound_statement> starting at the current token
+ * if the last parse of it can be reused, otherwise start recording it.
+ * @context:	the &Parse_Context of the document
+ *
+ * Return: 	0: the <compound_statement> has to be parsed
+ * 		1: the <compound_statement> was skipped
+ */
+int reuse_block(Parse_Context *context);
+
+/**
+ * end_block() - record the result of parsing the current
+ * <compound_statement>.
+ * @context:	the &Parse_Context of the document
+ */
+void end_block(Parse_Context *context);
+
+/**
+ * add_document_error() - record an error of the document being parsed.
+ * @context:		the &Parse_Context of the document
+ * @id:			the kind of error (see &enum error_id)
+ * @expected:		the kinds of tokens that were expected, or 0
+ * @message:		the error message
+ * @line_number:	the line where error occurs
+ * @start_col:		the column where the error starts
+ * @end_col:		the column where the error ends
+ */
+void add_document_error(Parse_Context *context, int id, Token_Set expected,
+			char *message, int line_number, int start_col,
+			int end_col);
+
+/**
+ * free_document() - cleanup the document.
+ * @document:	the &Document
+ */
+void free_document(Document *document);
+
+#endif /* INCREMENTAL_H */
@@ -0,0 +1,150 @@
+#include "keyword.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* the largest table tried before giving up on the keywords */
+#define KEYWORD_MAX_SIZE 65536
+/* the number of seeds tried for each size of table */
+#define KEYWORD_SEED_COUNT 4096
+
+/* same definition of a word character as `\b` in glibc (C locale) */
+static const unsigned char word_bytes[256] = {
+    ['0' ... '9'] = 1, ['A' ... 'Z'] = 1, ['a' ... 'z'] = 1, ['_'] = 1};
+#define is_word_byte(c) word_bytes[(unsigned char)(c)]
+
+/* the length of the word of a pattern made of `\b`, word characters and
+ * `\b` (the word starting right after the first `\b`), or 0 */
+static int get_literal_length(const char *pattern)
+{
+	size_t length = strlen(pattern);
+	if (length < 5 || strncmp(pattern, "\\b", 2) ||
+	    strcmp(pattern + length - 2, "\\b"))
+		return 0;
+	for (size_t i = 2; i < length - 2; ++i) {
+		if (!is_word_byte(pattern[i]))
+			return 0;
+	}
+	return length - 4 <= KEYWORD_MAX_LENGTH ? length - 4 : 0;
+}
+
+/* FNV-1a, seeded, with the length mixed in at the end */
+#define HASH_START(seed) ((uint32_t)2166136261u ^ (seed))
+#define HASH_STEP(hash, c) (((hash) ^ (unsigned char)(c)) * 16777619u)
+#define HASH_END(hash, length)                                                 \
+	(((hash) ^ (uint32_t)(length)) * 2654435761u >> 7)
+
+static uint32_t hash_word(uint32_t seed, const char *value, size_t length)
+{
+	uint32_t hash = HASH_START(seed);
+	for (size_t i = 0; i < length; ++i)
+		hash = HASH_STEP(hash, value[i]);
+	return HASH_END(hash, length);
+}
+
+int keyword_build(Keyword_Table *table, char **patterns, int count,
+		  int *is_keyword)
+{
+	int keyword_count = 0;
+	memset(table, 0, sizeof(Keyword_Table));
+	for (int i = 0; i < count; ++i) {
+		is_keyword[i] = get_literal_length(patterns[i]) > 0;
+		keyword_count += is_keyword[i];
+	}
+	if (!keyword_count)
+		return 0;
+
+	int size = 1;
+	while (size < 2 * keyword_count)
+		size <<= 1;
+	const char **words = NULL;
+	int16_t *lengths = NULL;
+	int16_t *tokens = NULL;
+	for (; size <= KEYWORD_MAX_SIZE; size <<= 1) {
+		words = (const char **)realloc(words, size * sizeof(char *));
+		lengths = (int16_t *)realloc(lengths, size * sizeof(int16_t));
+		tokens = (int16_t *)realloc(tokens, size * sizeof(int16_t));
+		for (uint32_t seed = 1; seed <= KEYWORD_SEED_COUNT; ++seed) {
+			int fits = 1;
+			memset(words, 0, size * sizeof(char *));
+			memset(lengths, 0, size * sizeof(int16_t));
+			memset(tokens, 0, size * sizeof(int16_t));
+			for (int i = 0; fits && i < count; ++i) {
+				if (!is_keyword[i])
+					continue;
+				const char *word = patterns[i] + 2;
+				int length = get_literal_length(patterns[i]);
+				uint32_t slot =
+				    hash_word(seed, word, length) & (size - 1);
+				if (!words[slot]) {
+					words[slot] = word;
+					lengths[slot] = length;
+					tokens[slot] = i;
+				} else if (lengths[slot] != length ||
+					   memcmp(words[slot], word, length)) {
+					/* the same keyword again never matches
+					 * anyway, the first one has precedence */
+					fits = 0;
+				}
+			}
+			if (!fits)
+				continue;
+			table->seed = seed;
+			table->size = size;
+			for (int i = 0; i < size; ++i) {
+				if (!words[i])
+					continue;
+				unsigned char c = words[i][0];
+				table->starts[c >> 3] |= 1 << (c & 7);
+				if (lengths[i] > table->max_length)
+					table->max_length = lengths[i];
+			}
+			table->words = words;
+			table->lengths = lengths;
+			table->tokens = tokens;
+			return 0;
+		}
+	}
+
+	/* the keywords are then left to the other matchers */
+	free(words);
+	free(lengths);
+	free(tokens);
+	for (int i = 0; i < count; ++i)
+		is_keyword[i] = 0;
+	return -1;
+}
+
+int keyword_match(const Keyword_Table *table, const char *value,
+		  size_t length, int *token)
+{
+	unsigned char c = length ? value[0] : 0;
+	if (!(table->starts[c >> 3] & 1 << (c & 7)))
+		return 0;
+	/* a keyword is the whole word, which is then not longer than the
+	 * longest keyword, the word is hashed while it is being scanned */
+	size_t max_length = table->max_length;
+	uint32_t hash = HASH_START(table->seed);
+	size_t word_length = 0;
+	do {
+		hash = HASH_STEP(hash, c);
+		if (++word_length == length)
+			break;
+		c = value[word_length];
+	} while (is_word_byte(c) && word_length <= max_length);
+	if (word_length > max_length)
+		return 0;
+	uint32_t slot = HASH_END(hash, word_length) & (table->size - 1);
+	if (table->lengths[slot] != (int16_t)word_length ||
+	    memcmp(table->words[slot], value, word_length))
+		return 0;
+	*token = table->tokens[slot];
+	return word_length;
+}
+
+void keyword_free(Keyword_Table *table)
+{
+	free((void *)table->words);
+	free((void *)table->lengths);
+	free((void *)table->tokens);
+	memset(table, 0, sizeof(Keyword_Table));
+}
@@ -0,0 +1,69 @@
+#ifndef KEYWORD_H
+#define KEYWORD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* maximum length of a keyword, longer literal words being left to the DFA */
+#define KEYWORD_MAX_LENGTH 64
+
+/**
+ * struct keyword_table (Keyword_Table) - perfect hash table of the keywords,
+ * i.e. the tokens whose pattern is a literal word between `\b`s (such as
+ * `\bbegin\b`), which match a whole word of the input or nothing.
+ * @seed:		the seed of the hash, making it collision-free on the
+ * 			keywords
+ * @size:		the number of slots, a power of 2 (0 if no keyword)
+ * @max_length:		the length of the longest keyword
+ * @starts:		bitmap of the bytes a keyword starts with
+ * @words:		for each slot, the keyword hashed to it, or NULL
+ * @lengths:		for each slot, the length of its keyword
+ * @tokens:		for each slot, the index of the token of its keyword
+ *
+ * Matching the keywords this way, the per-word cost is a hash and a memcmp()
+ * however many keywords there are, and the token DFA does not need a state
+ * for every prefix of every keyword.
+ */
+typedef struct keyword_table {
+	uint32_t seed;
+	int size;
+	int max_length;
+	unsigned char starts[32];
+	const char *const *words;
+	const int16_t *lengths;
+	const int16_t *tokens;
+} Keyword_Table;
+
+/**
+ * keyword_build() - find the keywords among the token patterns and build
+ * their perfect hash table.
+ * @table:	the &Keyword_Table to be built
+ * @patterns:	list of patterns, in order of precedence
+ * @count:	the number of patterns
+ * @is_keyword:	for each pattern, set to boolean indicates if it is a keyword
+ *
+ * Return: 	0: success
+ * 		-1: no collision-free hash has been found (no keyword then)
+ */
+int keyword_build(Keyword_Table *table, char **patterns, int count,
+		  int *is_keyword);
+
+/**
+ * keyword_match() - find the keyword the input starts with.
+ * @table:	the &Keyword_Table
+ * @value:	the input to be matched
+ * @length:	the length of the input
+ * @token:	the index of the token of the keyword
+ *
+ * Return: 	the length of the keyword (0 if none)
+ */
+int keyword_match(const Keyword_Table *table, const char *value,
+		  size_t length, int *token);
+
+/**
+ * keyword_free() - cleanup the table built by keyword_build().
+ * @table:	the &Keyword_Table
+ */
+void keyword_free(Keyword_Table *table);
+
+#endif /* KEYWORD_H */
@@ -1,27 +1,61 @@
 #include "lexical.h"
-#include "parse_error.h"
+#include "context.h"
+#include "incremental.h"
+#include "scan.h"
 #include "setting.h"
+#include "stats.h"
+#include "token_table.h"
 #include <ctype.h>
+#include <fcntl.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-extern Parse_Error *error_list;
-
-FILE *input_file;
 FILE *token_def_file;
 Token **token_list;
-char line[MAX_LINE_LENGTH];
-int line_number;
-int col_number;
-int has_tab_space = 0;
+Dfa token_dfa;
+Keyword_Table keyword_table;
+/* number of tokens matched with regex instead of the token DFA */
+static int regex_token_count = 0;
+/* for each first byte, the first token the DFA could match (keywords coming
+ * before it need no DFA match) */
+static int16_t first_dfa_tokens[256];
+/* boolean indicates if the token list is the one generated at build time */
+static int has_builtin_token_list = 0;
+
+int load_builtin_token_definitions()
+{
+	int return_value = 0;
+	select_scan_kernel();
+	token_list = builtin_token_list;
+	token_dfa = builtin_token_dfa;
+	keyword_table = builtin_keyword_table;
+	dfa_first_tokens(&token_dfa, first_dfa_tokens);
+	has_builtin_token_list = 1;
+	/* only the patterns the DFA does not support need compiling */
+	regex_token_count = 0;
+	for (int i = 0; token_list[i]; ++i) {
+		if (!token_list[i]->use_regex)
+			continue;
+		++regex_token_count;
+		return_value = setup_regex(&(token_list[i]->regex),
+					   token_list[i]->pattern);
+		if (return_value)
+			return return_value;
+	}
+	return 0;
+}
 
-int get_token_definitions()
+int get_token_definitions(char *file_name)
 {
 	int return_value = 0;
+	select_scan_kernel();
 	/* check if file exist */
-	if (!(token_def_file = fopen(TOKEN_DEFINITION_FILE, "r"))) {
-		printf("%sERROR - cannot open %s%s\n", ERROR_COL,
-		       TOKEN_DEFINITION_FILE, COL_RESET);
+	if (!(token_def_file = fopen(file_name, "r"))) {
+		printf("%sERROR - cannot open %s%s\n", ERROR_COL, file_name,
+		       COL_RESET);
 		return -1;
 	}
 	int token_list_length, max_token_name_length,
@@ -45,15 +79,22 @@ int get_token_definitions()
 		char *pattern_copy = (char *)malloc(strlen(pattern) + 1);
 		strcpy(pattern_copy, pattern);
 		new_token->pattern = pattern_copy;
-		regex_t regex;
-		/* check if the regex pattern is compilable */
-		return_value = setup_regex(&regex, pattern);
-		if (return_value)
-			return return_value;
-		new_token->regex = regex;
+		new_token->use_regex = 0;
+		/* tokens unknown to the syntax analyzer share the same kind */
+		new_token->kind = TOKEN_KIND_COUNT;
+		for (int kind = 0; kind < TOKEN_KIND_COUNT; ++kind) {
+			if (!strcmp(name, token_kind_names[kind]))
+				new_token->kind = kind;
+		}
 		*(token_list + i) = new_token;
 	}
 	*(token_list + token_list_length) = NULL;
+	free(name);
+	free(pattern);
+	/* check if the regex patterns are compilable */
+	return_value = build_token_dfa();
+	if (return_value)
+		return return_value;
 	/* check the number of definition in the file against the number
 	 * specified in the definition file header */
 	if (getc(token_def_file) != EOF) {
@@ -77,10 +118,14 @@ int setup_regex(regex_t *regex, char *regex_pattern)
 	return return_value;
 }
 
-int get_first_match(char *value, regex_t *regex)
+int get_first_match(const char *value, size_t length, regex_t *regex)
 {
 	regmatch_t pmatch[1];
-	int return_value = regexec(regex, value, 1, pmatch, 0);
+	/* the input is not NUL-terminated, the match is bounded instead */
+	pmatch->rm_so = 0;
+	pmatch->rm_eo = length;
+	stats_add(STATS_REGEXEC_CALLS, 1);
+	int return_value = regexec(regex, value, 1, pmatch, REG_STARTEND);
 	/* make sure the match start at position 0 (a left-most match) */
 	if (!return_value && !pmatch->rm_so) {
 		return pmatch->rm_eo;
@@ -88,130 +133,389 @@ int get_first_match(char *value, regex_t *regex)
 	return 0;
 }
 
-int lookup(Token **next_token)
+int build_token_dfa()
 {
 	int return_value = 0;
-	for (int i = 0; token_list[i]; ++i) {
-		return_value = get_first_match(line, &(token_list[i]->regex));
+	int token_list_length = 0;
+	while (token_list[token_list_length])
+		++token_list_length;
+	char **patterns = (char **)malloc(token_list_length * sizeof(char *));
+	int *use_dfa = (int *)malloc(token_list_length * sizeof(int));
+	int *is_keyword = (int *)malloc(token_list_length * sizeof(int));
+	for (int i = 0; i < token_list_length; ++i)
+		patterns[i] = token_list[i]->pattern;
+	/* the keywords are matched with their own table, not the DFA (they
+	 * are left to the DFA if the table cannot be built) */
+	keyword_build(&keyword_table, patterns, token_list_length, is_keyword);
+	for (int i = 0; i < token_list_length; ++i)
+		use_dfa[i] = !is_keyword[i] && dfa_is_supported(patterns[i]);
+	if (dfa_build(&token_dfa, patterns, token_list_length, use_dfa)) {
+		/* the patterns are too complex for the DFA, every token is
+		 * then matched with regex (the DFA built matches nothing) */
+		for (int i = 0; i < token_list_length; ++i)
+			use_dfa[i] = 0;
+		dfa_build(&token_dfa, patterns, token_list_length, use_dfa);
+	}
+	dfa_first_tokens(&token_dfa, first_dfa_tokens);
+	regex_token_count = 0;
+	for (int i = 0; i < token_list_length; ++i) {
+		if (use_dfa[i] || is_keyword[i])
+			continue;
+		token_list[i]->use_regex = 1;
+		++regex_token_count;
+		return_value = setup_regex(&(token_list[i]->regex), patterns[i]);
+		if (return_value)
+			break;
+	}
+	free(patterns);
+	free(use_dfa);
+	free(is_keyword);
+	return return_value;
+}
+
+int lookup(Lexer *lexer, Token **next_token)
+{
+	int token_index;
+	/* tokens never span lines, the current line bounds the match */
+	const char *value = lexer->input.content + lexer->cursor;
+	size_t length = lexer->line_end - lexer->cursor;
+	/* a keyword wins over the tokens coming after it in the token list, the
+	 * DFA is not even run if none of them can come before it */
+	int keyword_token;
+	int keyword_length =
+	    keyword_match(&keyword_table, value, length, &keyword_token);
+	int first_dfa_token = first_dfa_tokens[(unsigned char)*value];
+	int return_value;
+	if (keyword_length &&
+	    (first_dfa_token == DFA_NONE || keyword_token < first_dfa_token)) {
+		token_index = keyword_token;
+		return_value = keyword_length;
+		stats_add(STATS_KEYWORD_HITS, 1);
+	} else {
+		return_value =
+		    dfa_match(&token_dfa, value, length, &token_index);
+		stats_add(STATS_DFA_RUNS, 1);
+		if (keyword_length &&
+		    (token_index == DFA_NONE || keyword_token < token_index)) {
+			token_index = keyword_token;
+			return_value = keyword_length;
+			stats_add(STATS_KEYWORD_HITS, 1);
+		}
+	}
+	/* tokens left to regex only matter if they come before the token
+	 * matched by the DFA in the token list */
+	for (int i = 0; regex_token_count && token_list[i] &&
+			(token_index == DFA_NONE || i < token_index);
+	     ++i) {
+		if (!token_list[i]->use_regex)
+			continue;
+		int regex_value =
+		    get_first_match(value, length, &(token_list[i]->regex));
 		/* return the first matching token */
-		if (return_value) {
+		if (regex_value) {
 			*next_token = token_list[i];
-			return return_value;
+			return regex_value;
 		}
 	}
-	*next_token = NULL;
+	*next_token = token_index == DFA_NONE ? NULL : token_list[token_index];
 	return return_value;
 }
 
-int load_input(char *file_name)
+static void reset_lexer(Lexer *lexer)
 {
+	lexer->cursor = 0;
+	lexer->line_end = 0;
+	lexer->line_number = 0;
+	lexer->col_number = 0;
+	lexer->has_tab_space = 0;
+	/* the first line starts right away unless the file is empty */
+	start_line(lexer);
+}
+
+int load_input(Parse_Context *context, char *file_name)
+{
+	Lexer *lexer = &context->lexer;
+	Source *input = &lexer->input;
+	int file_descriptor;
+	struct stat file_stat;
+	context->file_name = file_name;
 	/* check if file exist */
-	if (!(input_file = fopen(file_name, "r"))) {
-		printf("%sERROR - cannot open file: %s%s\n", ERROR_COL,
-		       file_name, COL_RESET);
+	if ((file_descriptor = open(file_name, O_RDONLY)) < 0 ||
+	    fstat(file_descriptor, &file_stat) < 0) {
+		print_file_error(context, ERROR_CANNOT_OPEN_FILE,
+				 "cannot open file");
+		if (file_descriptor >= 0)
+			close(file_descriptor);
 		return -1;
 	}
 #if defined(DEBUG) && defined(LEX_DEBUG_ENABLED)
 	printf("%sProcessing file: %s%s\n", DEBUG_COL, file_name, COL_RESET);
 #endif
-	line_number = 0;
+	input->content = "";
+	input->length = 0;
+	input->is_mapped = 0;
+	input->is_borrowed = 0;
+	if (S_ISREG(file_stat.st_mode)) {
+		/* map the whole file, an empty file cannot be mapped */
+		if (file_stat.st_size > 0) {
+			void *content =
+			    mmap(NULL, file_stat.st_size, PROT_READ,
+				 MAP_PRIVATE, file_descriptor, 0);
+			if (content == MAP_FAILED) {
+				print_file_error(context, ERROR_CANNOT_OPEN_FILE,
+						 "cannot map file");
+				close(file_descriptor);
+				return -1;
+			}
+			madvise(content, file_stat.st_size, MADV_SEQUENTIAL);
+			input->content = content;
+			input->length = file_stat.st_size;
+			input->is_mapped = 1;
+		}
+	} else {
+		/* inputs that cannot be mapped (e.g. pipes) are read whole */
+		size_t capacity = 0;
+		char *content = NULL;
+		ssize_t read_size;
+		do {
+			if (input->length == capacity) {
+				capacity = capacity * 2 + 65536;
+				content = (char *)realloc(content, capacity);
+			}
+			read_size = read(file_descriptor,
+					 content + input->length,
+					 capacity - input->length);
+			if (read_size > 0)
+				input->length += read_size;
+		} while (read_size > 0);
+		input->content = content;
+	}
+	close(file_descriptor);
+	reset_lexer(lexer);
 	return 0;
 }
 
-Lex_Token *lex()
+void load_buffer(Parse_Context *context, char *name, const char *content,
+		 size_t length)
 {
-	/* always left-trimmed first*/
-	ltrim(line);
-	/* check for moving to a new line or EOF */
-	while (!strlen(line)) {
-		char *file_line = fgets(line, MAX_LINE_LENGTH, input_file);
-		if (!file_line) {
+	Source *input = &context->lexer.input;
+	context->file_name = name;
+	input->content = content;
+	input->length = length;
+	input->is_mapped = 0;
+	input->is_borrowed = 1;
+	reset_lexer(&context->lexer);
+}
+
+void unload_input(Lexer *lexer)
+{
+	Source *input = &lexer->input;
+	if (input->is_mapped)
+		munmap((void *)input->content, input->length);
+	else if (input->length && !input->is_borrowed)
+		free((void *)input->content);
+	input->content = NULL;
+	input->length = 0;
+	input->is_mapped = 0;
+	input->is_borrowed = 0;
+}
+
+void start_line(Lexer *lexer)
+{
+	Source *input = &lexer->input;
+	if (lexer->cursor == input->length)
+		return;
+	const char *newline =
+	    (const char *)memchr(input->content + lexer->cursor, '\n',
+				 input->length - lexer->cursor);
+	/* the newline belongs to the line it ends */
+	lexer->line_end = newline ? (size_t)(newline - input->content) + 1
+				  : input->length;
+	lexer->col_number = 0;
+	++lexer->line_number;
+#if defined(DEBUG) && defined(LEX_DEBUG_ENABLED)
+	printf("%sProcessing line %d%s\n", DEBUG_COL, lexer->line_number,
+	       COL_RESET);
+#endif
+}
+
+void advance(Lexer *lexer, int length)
+{
+	lexer->cursor += length;
+	lexer->col_number += length;
+	/* a lexeme never goes past the end of its line */
+	if (lexer->cursor == lexer->line_end &&
+	    lexer->input.content[lexer->cursor - 1] == '\n')
+		start_line(lexer);
+}
+
+/* step over a run of characters starting no token (as far as a blank),
+ * reported as a single error, then return the lookup of what follows it (0 if
+ * the run ends at a blank or EOF) */
+static int skip_unknown(Parse_Context *context, Token **next_token)
+{
+	Lexer *lexer = &context->lexer;
+	Source *input = &lexer->input;
+	size_t start = lexer->cursor;
+	int start_col = lexer->col_number, lexeme_upper_bound = 0;
+	do {
+		advance(lexer, 1);
+		if (lexer->cursor == input->length ||
+		    isspace((unsigned char)input->content[lexer->cursor]))
+			break;
+		lexeme_upper_bound = lookup(lexer, next_token);
+		stats_add_lookup(lexeme_upper_bound ? (*next_token)->kind
+						    : STATS_NO_TOKEN);
+	} while (!lexeme_upper_bound);
+	/* the newline being a blank, the run is on a single line */
+	add_error(context, ERROR_UNKNOWN_TOKEN, 0, "cannot identify token",
+		  lexer->line_number, start_col, lexer->col_number);
+	stats_add(STATS_LEXEME_BYTES, lexer->cursor - start);
+	return lexeme_upper_bound;
+}
+
+/* lex the next token of the input */
+static Lex_Token *lex_input(Parse_Context *context)
+{
+	Lexer *lexer = &context->lexer;
+	Token *next_token;
+	int lexeme_upper_bound;
+	/* unknown characters, exceedingly long tokens and comments are stepped
+	 * over until a token is found, notice here that comment is trimmed
+	 * before checking for long lexeme */
+	for (;;) {
+		/* always left-trimmed first, which also moves to the next
+		 * line(s) */
+		ltrim(lexer);
+		/* check for EOF */
+		if (lexer->cursor == lexer->input.length) {
 #if defined(DEBUG) && defined(LEX_DEBUG_ENABLED)
 			printf("%sReached end of file (EOF)%s\n", DEBUG_COL,
 			       COL_RESET);
 #endif
-			fclose(input_file);
 			/* EOF token is NULL */
 			return NULL;
 		}
-		col_number = 0;
-		++line_number;
-		ltrim(line);
-#if defined(DEBUG) && defined(LEX_DEBUG_ENABLED)
-		printf("%sProcessing line %d%s\n", DEBUG_COL, line_number,
-		       COL_RESET);
-#endif
-	}
-	Token *next_token;
-	int lexeme_upper_bound = lookup(&next_token);
-	/* handle unknown token, exceedingly long token and COMMENT
-	 * notice here that comment is trimmed before checking for long lexeme
-	 */
-	if (!lexeme_upper_bound) {
+		lexeme_upper_bound = lookup(lexer, &next_token);
+		stats_add_lookup(lexeme_upper_bound ? next_token->kind
+						    : STATS_NO_TOKEN);
 		/* 0 is returned for the ending position of the match, this
 		 * means there is no match */
-		add_error("ERROR - cannot identify token", line_number,
-			  col_number, col_number + 1);
-		/* take away the first character and call lex() again */
-		memmove(line, line + 1, strlen(line));
-		col_number += 1;
-		return lex();
-	} else if (!strcmp(next_token->name, "COMMENT")) {
-		/* strip comment */
-		memmove(line, line + lexeme_upper_bound,
-			strlen(line) - (lexeme_upper_bound - 1));
-		col_number += lexeme_upper_bound;
-		return lex();
-	} else if (lexeme_upper_bound > MAX_LEXEME_LENGTH) {
-		add_error("ERROR - lexeme is too long", line_number, col_number,
-			  col_number + lexeme_upper_bound);
-		/* take the long lexeme out and call lex() again */
-		memmove(line, line + lexeme_upper_bound,
-			strlen(line) - (lexeme_upper_bound - 1));
-		col_number += lexeme_upper_bound;
-		return lex();
-	}
-	/* handle legal token */
-	char *next_lexeme = (char *)malloc(lexeme_upper_bound * sizeof(char));
-	strncpy(next_lexeme, line, lexeme_upper_bound);
-	next_lexeme[lexeme_upper_bound] = '\0';
-	memmove(line, line + lexeme_upper_bound,
-		strlen(line) - (lexeme_upper_bound - 1));
+		if (!lexeme_upper_bound)
+			lexeme_upper_bound = skip_unknown(context, &next_token);
+		if (!lexeme_upper_bound)
+			continue;
+		if (next_token->kind == TOKEN_COMMENT) {
+			/* strip comment */
+			advance(lexer, lexeme_upper_bound);
+			stats_add(STATS_LEXEME_BYTES, lexeme_upper_bound);
+		} else if (lexeme_upper_bound > MAX_LEXEME_LENGTH) {
+			add_error(context, ERROR_LEXEME_TOO_LONG, 0,
+				  "lexeme is too long", lexer->line_number,
+				  lexer->col_number,
+				  lexer->col_number + lexeme_upper_bound);
+			/* take the long lexeme out */
+			advance(lexer, lexeme_upper_bound);
+			stats_add(STATS_LEXEME_BYTES, lexeme_upper_bound);
+		} else {
+			break;
+		}
+	}
+	/* handle legal token, the lexeme is left in the input */
+	Lex_Token *next_lex_token = &lexer->lex_token;
+	next_lex_token->offset = lexer->cursor;
+	next_lex_token->length = lexeme_upper_bound;
+	next_lex_token->token = next_token;
 #if defined(DEBUG) && defined(LEX_DEBUG_ENABLED)
-	printf("%sIdentified token %s, and lexeme '%s' [%d:%d-%d]%s\n",
-	       DEBUG_COL, next_token->name, next_lexeme, line_number,
-	       col_number + 1, col_number + lexeme_upper_bound + 1, COL_RESET);
+	printf("%sIdentified token %s, and lexeme '%.*s' [%d:%d-%d]%s\n",
+	       DEBUG_COL, next_token->name, lexeme_upper_bound,
+	       get_lexeme(lexer, next_lex_token), lexer->line_number,
+	       lexer->col_number + 1,
+	       lexer->col_number + lexeme_upper_bound + 1, COL_RESET);
 #endif
-	col_number += lexeme_upper_bound;
-
-	/* use static variable here instead of declaring it globally the
-	 * downside is that we will miss the deallocation of the last
-	 * next_lex_token */
-	static Lex_Token *next_lex_token = NULL;
-	if (!next_lex_token) {
-		next_lex_token = (Lex_Token *)malloc(sizeof(Lex_Token));
+	advance(lexer, lexeme_upper_bound);
+	stats_add(STATS_LEXEME_BYTES, lexeme_upper_bound);
+	return next_lex_token;
+}
+
+/* attach its symbol to the token, interning the identifiers where they start
+ * (the lexer is right after the token) */
+static void intern_token(Parse_Context *context, Lex_Token *lex_token)
+{
+	int kind = lex_token->token->kind;
+	if (kind != TOKEN_VARIABLE && kind != TOKEN_PROGNAME_VARIABLE) {
+		lex_token->symbol = NO_SYMBOL;
+		return;
+	}
+	Lexer *lexer = &context->lexer;
+	lex_token->symbol = intern_symbol(
+	    &context->symbols, get_lexeme(lexer, lex_token), lex_token->length,
+	    lexer->line_number, lexer->col_number - lex_token->length);
+}
+
+Lex_Token *lex(Parse_Context *context)
+{
+	Lex_Token *lex_token;
+	/* the input ends where the parsing was given up */
+	if (context->has_given_up)
+		return NULL;
+	if (context->document) {
+		lex_token = next_document_token(context);
+	} else if (context->token_stream.state == STREAM_READING) {
+		lex_token = next_stream_token(context);
+	} else if (context->token_queue) {
+		lex_token = next_queued_token(context);
+	} else if (!stats_enabled) {
+		lex_token = lex_input(context);
 	} else {
-		free(next_lex_token->lexeme);
+		uint64_t start = stats_now();
+		lex_token = lex_input(context);
+		stats_stop(STATS_LEX, start);
 	}
-	next_lex_token->lexeme = next_lexeme;
-	next_lex_token->token = next_token;
-	return next_lex_token;
+	/* the identifiers are interned as the syntax analyzer gets them, not
+	 * while the token stream is filled nor by the lexer thread */
+	if (context->options.symbols && lex_token &&
+	    context->token_stream.state != STREAM_FILLING &&
+	    !context->lexer_queue)
+		intern_token(context, lex_token);
+	return lex_token;
 }
 
-char *ltrim(char *value)
+const char *get_lexeme(Lexer *lexer, Lex_Token *lex_token)
 {
-	while (isspace(*value)) {
+	return lexer->input.content + lex_token->offset;
+}
+
+void ltrim(Lexer *lexer)
+{
+	Source *input = &lexer->input;
+	size_t start = lexer->cursor;
+	while (lexer->cursor < input->length &&
+	       isspace((unsigned char)input->content[lexer->cursor])) {
+		const char *value = input->content + lexer->cursor;
+		/* runs of spaces (e.g. indentation) are skipped at once, they
+		 * never go past the end of the line */
+		if (value[0] == ' ' && lexer->cursor + 1 < lexer->line_end &&
+		    value[1] == ' ') {
+			size_t run = scan_run(SCAN_BLANK, value,
+					      lexer->line_end - lexer->cursor);
+			lexer->cursor += run;
+			lexer->col_number += run;
+			continue;
+		}
 		/* detect tab usage since tab will mess up error messages'
 		 * location information */
-		if (*value == '\t') {
-			has_tab_space = 1;
-			col_number = col_number + TAB_SIZE;
+		char c = input->content[lexer->cursor++];
+		if (c == '\t') {
+			lexer->has_tab_space = 1;
+			lexer->col_number = lexer->col_number + TAB_SIZE;
 		} else {
-			++col_number;
+			++lexer->col_number;
 		}
-		memmove(value, value + 1, strlen(value));
+		if (c == '\n')
+			start_line(lexer);
 	}
-	return value;
+	stats_add(STATS_BLANK_BYTES, lexer->cursor - start);
 }
 
 void clean_lex()
@@ -219,13 +523,27 @@ void clean_lex()
 #if defined(DEBUG) && defined(PARSE_DEBUG_ENABLED)
 	printf("%sCleaning up token definition list%s\n", INFO_COL, COL_RESET);
 #endif
+	if (has_builtin_token_list) {
+		for (int i = 0; token_list[i]; ++i) {
+			if (token_list[i]->use_regex)
+				regfree(&(token_list[i]->regex));
+		}
+		token_list = NULL;
+		memset(&keyword_table, 0, sizeof(Keyword_Table));
+		has_builtin_token_list = 0;
+		return;
+	}
 	for (int i = 0; token_list[i]; ++i) {
 		free(token_list[i]->name);
 		token_list[i]->name = NULL;
 		free(token_list[i]->pattern);
 		token_list[i]->pattern = NULL;
-		regfree(&(token_list[i]->regex));
+		if (token_list[i]->use_regex)
+			regfree(&(token_list[i]->regex));
+		free(token_list[i]);
 	}
 	free(token_list);
 	token_list = NULL;
+	dfa_free(&token_dfa);
+	keyword_free(&keyword_table);
 }
@@ -1,54 +1,125 @@
 #ifndef LEX_H
 #define LEX_H
 
+#include "dfa.h"
+#include "keyword.h"
 #include <regex.h>
+#include <stdint.h>
 #include <stdio.h>
 
+/* set of token kinds, one bit per kind */
+typedef uint64_t Token_Set;
+#define TOKEN_BIT(kind) ((Token_Set)1 << (kind))
+
 /** 
  * struct token (Token) - store information from token definition file.
  * @name:	name of the token
  * @pattern:	POSIX regex pattern to match the token
- * @regex:	the compiled regex using the pattern
+ * @use_regex:	boolean indicates if the pattern cannot be compiled into the
+ * 		token DFA and has to be matched with @regex instead
+ * @regex:	the compiled regex using the pattern (only if @use_regex)
+ * @kind:	the kind of the token (see &enum token_kind)
  */
 typedef struct token {
 	char *name;
 	char *pattern;
+	int use_regex;
 	regex_t regex;
+	int kind;
 } Token;
 
+/**
+ * struct source (Source) - the whole input file, mapped in memory.
+ * @content:	the content of the file (not NUL-terminated)
+ * @length:	the length of the content
+ * @is_mapped:	boolean indicates if @content is mapped, otherwise it has been
+ * 		read into an allocated buffer (input that cannot be mapped)
+ * @is_borrowed:	boolean indicates if @content belongs to the caller
+ * 			of load_buffer() and is left alone on unloading
+ */
+typedef struct source {
+	const char *content;
+	size_t length;
+	int is_mapped;
+	int is_borrowed;
+} Source;
+
 /** 
- * struct lex_token (Lex_Token) - store information of a lexeme.
- * @lexeme:	the content of the lexeme
+ * struct lex_token (Lex_Token) - store information of a lexeme, as a slice of
+ * the input (the lexeme is not copied).
+ * @offset:	the position of the lexeme in the input
+ * @length:	the length of the lexeme
+ * @symbol:	the symbol of the identifier in the &Symbol_Table of the
+ * 		context, NO_SYMBOL for the other tokens (only set with
+ * 		--symbols)
  * @token:	the token the lexeme is associated with
  */
 typedef struct lex_token {
-	char *lexeme;
+	size_t offset;
+	int length;
+	uint32_t symbol;
 	Token *token;
 } Lex_Token;
 
-/* FILE pointer of the input file */
-extern FILE *input_file;
+/**
+ * struct lexer (Lexer) - state of the lexical analyzer for an input.
+ * @input:		the input file
+ * @cursor:		the current position in the input
+ * @line_end:		the end of the current line (past its newline)
+ * @line_number:	the current line number
+ * @col_number:		the current column number
+ * @has_tab_space:	boolean indicates if tab usage has been spotted
+ * @lex_token:		the last token found
+ */
+typedef struct lexer {
+	Source input;
+	size_t cursor;
+	size_t line_end;
+	int line_number;
+	int col_number;
+	int has_tab_space;
+	Lex_Token lex_token;
+} Lexer;
+
+/* defined in context.h */
+typedef struct parse_context Parse_Context;
+
 /* FILE pointer of the token definition file */
 extern FILE *token_def_file;
 /* list of token collected from the token definition file */
 extern Token **token_list;
-/* the current line being read */
-extern char line[];
-/* the current line number */
-extern int line_number;
-/* the current column number */
-extern int col_number;
-/* boolean indicates if tab usage has been spotted */
-extern int has_tab_space;
+/* DFA matching all the token patterns it supports at once */
+extern Dfa token_dfa;
+/* perfect hash table of the keywords, left out of the DFA */
+extern Keyword_Table keyword_table;
 
 /**
- * load_input() - load the input file.
+ * load_input() - map the input file in memory and start lexing at its
+ * beginning.
+ * @context:	the &Parse_Context
  * @file_name: 	name of the file
  *
  * Return: 	0: success
  * 		-1: file not found
  */
-int load_input(char *file_name);
+int load_input(Parse_Context *context, char *file_name);
+
+/**
+ * load_buffer() - use an input already in memory, which must outlive the
+ * parsing, and reset the lexical analyzer to its beginning.
+ * @context:	the &Parse_Context
+ * @name: 	name of the input
+ * @content:	the content of the input
+ * @length:	the length of the content
+ */
+void load_buffer(Parse_Context *context, char *name, const char *content,
+		 size_t length);
+
+/**
+ * unload_input() - unmap the input file.
+ * @lexer:	the &Lexer
+ */
+void unload_input(Lexer *lexer);
 
 /**
  * setup_regex() - compile the regex.
@@ -59,47 +130,91 @@ int load_input(char *file_name);
  */
 int setup_regex(regex_t *regex, char *regex_pattern);
 
+/**
+ * load_builtin_token_definitions() - use the token list and the token DFA
+ * generated from the token definition file at build time.
+ *
+ * Return: 	0: 		success
+ * 		otherwise:	value of setup_regex()
+ */
+int load_builtin_token_definitions(void);
+
 /**
  * get_token_definitions() - load token definition file and create token list.
+ * @file_name:	name of the token definition file
  *
  * Return: 	0: 		success
  * 		-1: 		file not found
  * 		otherwise:	value of setup_regex()
  */
-int get_token_definitions(void);
+int get_token_definitions(char *file_name);
 
 /**
  * get_first_match() - check if the regex matches the lexeme from the
  * starting position (a left-most match).
  * @value: 	the string to be matched against
+ * @length: 	the length of the string
  * @regex:	the compile regex
  *
  * Return: 	the ending position of the match
  */
-int get_first_match(char *value, regex_t *regex);
+int get_first_match(const char *value, size_t length, regex_t *regex);
+
+/**
+ * start_line() - move to the line starting at the cursor, if any.
+ * @lexer:	the &Lexer
+ */
+void start_line(Lexer *lexer);
 
 /**
- * ltrim() - left-trim trailing space and notify if tab usage was detected.
- * @value: 	the string to be trimmed
+ * advance() - move the cursor past the lexeme at the cursor.
+ * @lexer:	the &Lexer
+ * @length: 	the length of the lexeme
+ */
+void advance(Lexer *lexer, int length);
+
+/**
+ * ltrim() - skip the space at the cursor (moving through lines) and notify if
+ * tab usage was detected.
+ * @lexer:	the &Lexer
+ */
+void ltrim(Lexer *lexer);
+
+/**
+ * build_token_dfa() - compile the token patterns into the token DFA, tokens
+ * whose pattern the DFA does not support get their regex compiled instead.
  *
- * Return: 	the trimmed string
+ * Return: 	0: 		success
+ * 		otherwise:	value of setup_regex()
  */
-char *ltrim(char *value);
+int build_token_dfa(void);
 
 /**
  * lookup() - find the first token to match the lexeme.
+ * @lexer:	the &Lexer
  * @next_token:	the next token
  *
  * Return: 	the ending position of the match
  */
-int lookup(Token **next_token);
+int lookup(Lexer *lexer, Token **next_token);
+
+/**
+ * get_lexeme() - get the content of a lexeme.
+ * @lexer:	the &Lexer
+ * @lex_token:	the lexeme
+ *
+ * Return: 	the beginning of the lexeme in the input (not NUL-terminated,
+ * 		see @lex_token->length)
+ */
+const char *get_lexeme(Lexer *lexer, Lex_Token *lex_token);
 
 /**
  * lex() - get the next token from the input file.
+ * @context:	the &Parse_Context
  *
  * Return: 	the next token and next lexeme wrapped inside a &Lex_Token
  */
-Lex_Token *lex(void);
+Lex_Token *lex(Parse_Context *context);
 
 /**
  * clean_lex() - cleanup token definition list.
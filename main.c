@@ -0,0 +1,292 @@
+#include "batch.h"
+#include "lexical.h"
+#include "parser.h"
+#include "server.h"
+#include "setting.h"
+#include "stats.h"
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* command line options */
+static struct option long_options[] = {
+    {"token-definitions", required_argument, NULL, 't'},
+    {"jobs", required_argument, NULL, 'j'},
+    {"files-from", required_argument, NULL, 'f'},
+    {"format", required_argument, NULL, 'F'},
+    {"ast", optional_argument, NULL, 'a'},
+    {"serve", required_argument, NULL, 's'},
+    {"engine", required_argument, NULL, 'e'},
+    {"lex-first", no_argument, NULL, 'l'},
+    {"lex-only", no_argument, NULL, 'o'},
+    {"pipeline", no_argument, NULL, 'p'},
+    {"stats", optional_argument, NULL, 'S'},
+    {"trace", required_argument, NULL, 'T'},
+    {"events", no_argument, NULL, 'E'},
+    {"symbols", no_argument, NULL, 'Y'},
+    {"context", required_argument, NULL, 'C'},
+    {"recovery", required_argument, NULL, 'r'},
+    {"max-errors", required_argument, NULL, 'm'},
+    {NULL, 0, NULL, 0}};
+
+/* names of the formats accepted by --format, in &enum output_format order */
+static const char *format_names[] = {"text", "jsonl", "sarif", NULL};
+/* names of the engines accepted by --engine, in &enum parse_engine order */
+static const char *engine_names[] = {"recursive", "table", NULL};
+/* names of the modes accepted by --recovery, in &enum recovery_mode order */
+static const char *recovery_names[] = {"continue", "panic", NULL};
+
+static void print_usage(char *program_name)
+{
+	printf("Usage: %s [<options>] <input_file>\n"
+	       "       %s [<options>] [--jobs <n>] [--files-from <list_file>] "
+	       "<input_file>...\n"
+	       "       %s [<options>] [--jobs <n>] --serve <socket>\n"
+	       "Options: [--token-definitions <file>] "
+	       "[--format=text|jsonl|sarif] [--ast[=tree]] "
+	       "[--engine=recursive|table] "
+	       "[--lex-first|--pipeline] [--lex-only] [--stats[=json]] "
+	       "[--trace=<trace_file>] [--events] [--symbols] [--context <n>] "
+	       "[--recovery=continue|panic] [--max-errors <n>]\n",
+	       program_name, program_name, program_name);
+}
+
+/* find the index of the name of an option value, -1 if unknown */
+static int find_name(char *name, const char **names)
+{
+	for (int index = 0; names[index]; ++index) {
+		if (!strcmp(name, names[index]))
+			return index;
+	}
+	return -1;
+}
+
+/* main driver */
+int main(int argc, char **argv)
+{
+#ifdef DEBUG
+	printf("%sDEBUG MODE ENABLED%s\n", DEBUG_COL, COL_RESET);
+#endif
+	int return_value = 0;
+	char *token_definition_file = NULL;
+	char *list_file = NULL;
+	char *socket_path = NULL;
+	char *trace_file = NULL;
+	int is_events_printed = 0;
+	int is_pipelined = 0;
+	int job_count = 0;
+	Parse_Options options = {.format = OUTPUT_TEXT, .context_lines = -1};
+	int option;
+	while ((option = getopt_long(argc, argv, "t:j:f:", long_options,
+				     NULL)) != -1) {
+		switch (option) {
+		case 't':
+			token_definition_file = optarg;
+			break;
+		case 'j':
+			job_count = atoi(optarg);
+			if (job_count <= 0 ||
+			    strspn(optarg, "0123456789") != strlen(optarg)) {
+				print_usage(argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'f':
+			list_file = optarg;
+			break;
+		case 's':
+			socket_path = optarg;
+			break;
+		case 'a':
+			/* --ast builds the AST, --ast=tree prints it too */
+			if (!optarg) {
+				options.ast_mode = AST_MODE_SUMMARY;
+			} else if (!strcmp(optarg, "tree")) {
+				options.ast_mode = AST_MODE_TREE;
+			} else {
+				print_usage(argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'F':
+			if ((options.format = find_name(optarg, format_names)) <
+			    0) {
+				print_usage(argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'e':
+			if ((options.engine = find_name(optarg, engine_names)) <
+			    0) {
+				print_usage(argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'r':
+			if ((options.recovery =
+				 find_name(optarg, recovery_names)) < 0) {
+				print_usage(argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'm':
+			options.max_errors = atoi(optarg);
+			if (options.max_errors <= 0 ||
+			    strspn(optarg, "0123456789") != strlen(optarg)) {
+				print_usage(argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'l':
+			/* --lex-only --lex-first only fills the token stream */
+			options.lex_mode = options.lex_mode == LEX_MODE_ONLY
+					       ? LEX_MODE_ONLY_FIRST
+					       : LEX_MODE_FIRST;
+			break;
+		case 'o':
+			options.lex_mode = options.lex_mode == LEX_MODE_FIRST
+					       ? LEX_MODE_ONLY_FIRST
+					       : LEX_MODE_ONLY;
+			break;
+		case 'p':
+			is_pipelined = 1;
+			break;
+		case 'S':
+			/* --stats prints the report as text, --stats=json as
+			 * JSON */
+			if (optarg && strcmp(optarg, "json")) {
+				print_usage(argv[0]);
+				exit(EXIT_FAILURE);
+			}
+#if STATS_ENABLED == 1
+			stats_enabled = optarg ? STATS_JSON : STATS_TEXT;
+#endif
+			break;
+		case 'T':
+			trace_file = optarg;
+			break;
+		case 'E':
+			is_events_printed = 1;
+			break;
+		case 'Y':
+			options.symbols = 1;
+			break;
+		case 'C':
+			/* the source code is only shown around the errors */
+			options.context_lines = atoi(optarg);
+			if (options.context_lines < 0 ||
+			    strspn(optarg, "0123456789") != strlen(optarg)) {
+				print_usage(argv[0]);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		default:
+			print_usage(argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	/* use the token definitions compiled in at build time unless another
+	 * token definition file is given */
+	uint64_t start = stats_start();
+	if (token_definition_file)
+		return_value = get_token_definitions(token_definition_file);
+	else
+		return_value = load_builtin_token_definitions();
+	stats_stop(STATS_TOKEN_DEFINITIONS, start);
+
+	/* check token definition file is loaded properly */
+	if (return_value)
+		return -2;
+
+	/* the output stays bounded when the parsing can be given up, the
+	 * source code being only shown around the errors reported */
+	if (options.max_errors && options.context_lines < 0)
+		options.context_lines = MAX_ERRORS_CONTEXT_LINES;
+
+	/* the lexer thread lexes token by token, as the syntax analyzer
+	 * asks */
+	if (is_pipelined) {
+		if (options.lex_mode != LEX_MODE_INTERLEAVED) {
+			printf("%sERROR - --pipeline cannot be combined with "
+			       "--lex-first or --lex-only%s\n",
+			       ERROR_COL, COL_RESET);
+			exit(EXIT_FAILURE);
+		}
+		options.lex_mode = LEX_MODE_PIPELINED;
+	}
+
+	/* a trace follows a single syntax analysis */
+	if (trace_file && (socket_path || job_count || list_file ||
+			   argc - optind > 1)) {
+		printf("%sERROR - --trace only traces the parsing of a single "
+		       "input%s\n",
+		       ERROR_COL, COL_RESET);
+		exit(EXIT_FAILURE);
+	}
+	if (is_events_printed && (socket_path || job_count || list_file ||
+				  argc - optind > 1)) {
+		printf("%sERROR - --events only reports the parsing of a "
+		       "single input%s\n",
+		       ERROR_COL, COL_RESET);
+		exit(EXIT_FAILURE);
+	}
+
+	/* answer the requests of the clients until stopped */
+	if (socket_path) {
+		if (!job_count)
+			job_count = sysconf(_SC_NPROCESSORS_ONLN);
+		return_value = run_server(socket_path, job_count, &options);
+		clean_lex();
+		print_stats(stderr);
+		exit(return_value);
+	}
+
+	/* parse several files at once in batch mode */
+	if (job_count || list_file || argc - optind > 1) {
+		if (!job_count)
+			job_count = sysconf(_SC_NPROCESSORS_ONLN);
+		return_value = run_batch(argv + optind, argc - optind,
+					 list_file, job_count, &options);
+		clean_lex();
+		print_stats(stderr);
+		exit(return_value);
+	}
+
+	/* check if the argument indicating the input file is specfied */
+	if (optind >= argc) {
+		printf("You must supply the input file name "
+		       "on the command line\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/* check if the input is loaded properly */
+	Parse_Context context;
+	init_context(&context, &options, stdout);
+	if (trace_file && !(context.trace = open_trace(trace_file))) {
+		printf("%sERROR - cannot create the trace file %s%s\n",
+		       ERROR_COL, trace_file, COL_RESET);
+		exit(EXIT_FAILURE);
+	}
+	/* the events are printed along with the messages */
+	Parse_Events events;
+	if (is_events_printed) {
+		init_printed_events(&events, &context.out);
+		context.events = &events;
+	}
+	print_report_header(&context.out, options.format);
+	return_value = parse_file(&context, argv[optind]);
+	print_report_footer(&context.out, options.format);
+	if (context.trace && close_trace(context.trace))
+		printf("%sERROR - cannot write the trace file %s%s\n",
+		       ERROR_COL, trace_file, COL_RESET);
+	/* cleanup the mess the parser left behind */
+	clean_context(&context);
+	clean_lex();
+	print_stats(stderr);
+	if (return_value < 0)
+		exit(EXIT_FAILURE);
+	exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,198 @@
+#include "merc.h"
+#include "context.h"
+#include "incremental.h"
+#include "lexical.h"
+#include "parser.h"
+#include "token_table.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+_Static_assert(MERC_ENGINE_RECURSIVE == ENGINE_RECURSIVE &&
+		   MERC_ENGINE_TABLE == ENGINE_TABLE,
+	       "the engines of the library are the ones of the parser");
+_Static_assert(MERC_RECOVERY_CONTINUE == RECOVERY_CONTINUE &&
+		   MERC_RECOVERY_PANIC == RECOVERY_PANIC,
+	       "the recovery modes of the library are the ones of the parser");
+
+/**
+ * struct merc_parser (Merc_Parser) - a parser of the library.
+ * @context:	the &Parse_Context every buffer is parsed with
+ * @options:	the &Parse_Options of every buffer
+ * @events:	the callbacks the parsing is reported to
+ * @next_error:	the error merc_next_diagnostic() returns next
+ */
+struct merc_parser {
+	Parse_Context context;
+	Parse_Options options;
+	Parse_Events events;
+	Parse_Error *next_error;
+};
+
+/**
+ * struct merc_document (Merc_Document) - a document of the library.
+ * @document:	the &Document
+ * @next_error:	the error merc_document_next_diagnostic() returns next
+ */
+struct merc_document {
+	Document *document;
+	Parse_Error *next_error;
+};
+
+/* name the buffers are parsed under */
+static char buffer_name[] = "<buffer>";
+
+/* the token definitions built in are shared by all the parsers */
+static pthread_once_t token_definitions_once = PTHREAD_ONCE_INIT;
+static int token_definitions_status;
+
+static void load_token_definitions(void)
+{
+	token_definitions_status = load_builtin_token_definitions();
+}
+
+Merc_Parser *merc_create_parser(const Merc_Options *options)
+{
+	Merc_Options defaults = {0};
+	if (!options)
+		options = &defaults;
+	if (options->engine < MERC_ENGINE_RECURSIVE ||
+	    options->engine > MERC_ENGINE_TABLE ||
+	    options->recovery < MERC_RECOVERY_CONTINUE ||
+	    options->recovery > MERC_RECOVERY_PANIC || options->max_errors < 0)
+		return NULL;
+	pthread_once(&token_definitions_once, load_token_definitions);
+	if (token_definitions_status)
+		return NULL;
+
+	Merc_Parser *parser = (Merc_Parser *)malloc(sizeof(Merc_Parser));
+	parser->options = (Parse_Options){.format = OUTPUT_TEXT,
+					  .engine = options->engine,
+					  .context_lines = -1,
+					  .recovery = options->recovery,
+					  .max_errors = options->max_errors};
+	/* the messages are only buffered, the diagnostics being read from the
+	 * error list instead */
+	init_context(&parser->context, &parser->options, NULL);
+	parser->next_error = NULL;
+	return parser;
+}
+
+int merc_parse_buffer(Merc_Parser *parser, const char *buffer, size_t length)
+{
+	Parse_Context *context = &parser->context;
+	merc_reset_parser(parser);
+	load_buffer(context, buffer_name, buffer, length);
+	parse(context);
+	/* the errors are copied into the error arena, the buffer is not needed
+	 * anymore */
+	unload_input(&context->lexer);
+	parser->next_error = context->error_list;
+	return context->error_count;
+}
+
+void merc_set_events(Merc_Parser *parser, const Merc_Events *events)
+{
+	if (!events) {
+		parser->context.events = NULL;
+		return;
+	}
+	parser->events.enter = events->enter;
+	parser->events.exit = events->exit;
+	parser->events.terminal = events->terminal;
+	parser->events.user_data = events->user_data;
+	parser->context.events = &parser->events;
+}
+
+/* fill the diagnostic of an error */
+static void fill_diagnostic(Merc_Diagnostic *diagnostic, Parse_Error *error)
+{
+	diagnostic->id = error_id_names[error->id];
+	diagnostic->message = error->message;
+	diagnostic->line = error->line_number;
+	/* the columns are counted from 1 as in the messages */
+	diagnostic->start_column = error->start_col + 1;
+	diagnostic->end_column =
+	    error->end_col == END_OF_LINE_COL ? 0 : error->end_col + 1;
+}
+
+int merc_next_diagnostic(Merc_Parser *parser, Merc_Diagnostic *diagnostic)
+{
+	Parse_Error *error = parser->next_error;
+	if (!error)
+		return 0;
+	fill_diagnostic(diagnostic, error);
+	parser->next_error = error->next;
+	return 1;
+}
+
+void merc_reset_parser(Merc_Parser *parser)
+{
+	reset_context(&parser->context, &parser->options);
+	reset_output(&parser->context.out);
+	parser->next_error = NULL;
+}
+
+const char *merc_non_terminal_name(int non_terminal)
+{
+	return non_terminal >= 0 && non_terminal < NON_TERMINAL_COUNT
+		   ? non_terminal_names[non_terminal]
+		   : NULL;
+}
+
+const char *merc_token_kind_name(int kind)
+{
+	return kind >= 0 && kind < TOKEN_KIND_COUNT ? token_kind_names[kind]
+						    : NULL;
+}
+
+void merc_free_parser(Merc_Parser *parser)
+{
+	clean_context(&parser->context);
+	free(parser);
+}
+
+Merc_Document *merc_create_document(void)
+{
+	pthread_once(&token_definitions_once, load_token_definitions);
+	if (token_definitions_status)
+		return NULL;
+	Merc_Document *document = (Merc_Document *)malloc(sizeof(Merc_Document));
+	document->document = create_document();
+	document->next_error = NULL;
+	return document;
+}
+
+int merc_document_parse(Merc_Document *document, const char *content,
+			size_t length)
+{
+	int error_count = document_parse(document->document, content, length);
+	document->next_error = document_errors(document->document);
+	return error_count;
+}
+
+int merc_document_edit(Merc_Document *document, size_t start, size_t end,
+		       const char *replacement, size_t length)
+{
+	int error_count = document_edit(document->document, start, end,
+					replacement, length);
+	if (error_count >= 0)
+		document->next_error = document_errors(document->document);
+	return error_count;
+}
+
+int merc_document_next_diagnostic(Merc_Document *document,
+				  Merc_Diagnostic *diagnostic)
+{
+	Parse_Error *error = document->next_error;
+	if (!error)
+		return 0;
+	fill_diagnostic(diagnostic, error);
+	document->next_error = error->next;
+	return 1;
+}
+
+void merc_free_document(Merc_Document *document)
+{
+	free_document(document->document);
+	free(document);
+}
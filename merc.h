@@ -0,0 +1,244 @@
+#ifndef MERC_H
+#define MERC_H
+
+#include <stddef.h>
+
+/*
+ * libmerc - the parser as a library (make lib builds libmerc.a and
+ * libmerc.so), for programs parsing inputs they hold in memory without
+ * running ./parse. This header is all a program needs, it does not depend on
+ * the other headers of the parser.
+ *
+ * A &Merc_Parser is created once and parses any number of buffers, one at a
+ * time, reusing its memory from one buffer to the next. The diagnostics of
+ * the last buffer parsed are then read with merc_next_diagnostic(), and
+ * merc_set_events() has the parser report what it goes through while parsing
+ * instead of building it (in memory proportional to the nesting). Parsers
+ * share nothing but the token definitions built in at build time, so several
+ * threads can each parse with their own parser at the same time.
+ *
+ *	Merc_Parser *parser = merc_create_parser(NULL);
+ *	Merc_Diagnostic diagnostic;
+ *	if (merc_parse_buffer(parser, buffer, length) > 0)
+ *		while (merc_next_diagnostic(parser, &diagnostic))
+ *			printf("%d:%d %s\n", diagnostic.line,
+ *			       diagnostic.start_column, diagnostic.message);
+ *	merc_free_parser(parser);
+ *
+ * An editor keeps an input open as a &Merc_Document instead: it is parsed
+ * once with merc_document_parse(), then each merc_document_edit() replaces a
+ * range of it and parses it again, re-lexing only the edited lines and
+ * reusing the blocks around them, the diagnostics being the ones a full parse
+ * of the new content gives (read with merc_document_next_diagnostic()).
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* only the functions below are exported by the library */
+#define MERC_API __attribute__((visibility("default")))
+
+/* the syntax analyzers (see --engine) */
+#define MERC_ENGINE_RECURSIVE 0
+#define MERC_ENGINE_TABLE 1
+
+/* what is done after a syntax error (see --recovery) */
+#define MERC_RECOVERY_CONTINUE 0
+#define MERC_RECOVERY_PANIC 1
+
+/**
+ * struct merc_options (Merc_Options) - how a &Merc_Parser parses, all 0 being
+ * the defaults of ./parse.
+ * @engine:	the syntax analyzer (MERC_ENGINE_RECURSIVE or
+ * 		MERC_ENGINE_TABLE)
+ * @recovery:	what is done after a syntax error (MERC_RECOVERY_CONTINUE or
+ * 		MERC_RECOVERY_PANIC)
+ * @max_errors:	how many errors are reported before giving up, 0 for no
+ * 		limit (see --max-errors)
+ */
+typedef struct merc_options {
+	int engine;
+	int recovery;
+	int max_errors;
+} Merc_Options;
+
+/**
+ * struct merc_diagnostic (Merc_Diagnostic) - an error of the buffer parsed,
+ * valid until the parser parses another buffer or is reset.
+ * @id:			the kind of error, as in --format=jsonl (e.g.
+ * 			"unexpected-token")
+ * @message:		the error message, as printed by ./parse
+ * @line:		the line of the error, from 1
+ * @start_column:	the column where the error starts, from 1
+ * @end_column:		the column where the error ends, 0 if it runs to the
+ * 			end of the line
+ */
+typedef struct merc_diagnostic {
+	const char *id;
+	const char *message;
+	int line;
+	int start_column;
+	int end_column;
+} Merc_Diagnostic;
+
+/**
+ * struct merc_events (Merc_Events) - callbacks called while a buffer is
+ * parsed, any of which can be NULL, so that a program can follow the syntax
+ * analysis without building anything of it.
+ * @enter:	called on entering a non-terminal (see
+ * 		merc_non_terminal_name()), at the position of the token it
+ * 		starts with (the start of the buffer for the whole program)
+ * @exit:	called on exiting a non-terminal, at the position of the token
+ * 		following it (or the end of the buffer), but not for the
+ * 		non-terminals still being parsed when the buffer ends
+ * 		unexpectedly or junk follows the program
+ * @terminal:	called when a token is accepted, with its kind (see
+ * 		merc_token_kind_name()), its lexeme (in the buffer, not
+ * 		NUL-terminated) and its position
+ * @user_data:	passed to each callback
+ *
+ * The lines and columns are counted from 1, as in the diagnostics.
+ */
+typedef struct merc_events {
+	void (*enter)(void *user_data, int non_terminal, int line, int column);
+	void (*exit)(void *user_data, int non_terminal, int line, int column);
+	void (*terminal)(void *user_data, int kind, const char *lexeme,
+			 int length, int line, int column);
+	void *user_data;
+} Merc_Events;
+
+typedef struct merc_parser Merc_Parser;
+
+/**
+ * merc_create_parser() - create a parser.
+ * @options:	the &Merc_Options, or NULL for the defaults
+ *
+ * Return: 	the &Merc_Parser, or NULL if the token definitions could not be
+ * 		set up or the options are not valid
+ */
+MERC_API Merc_Parser *merc_create_parser(const Merc_Options *options);
+
+/**
+ * merc_parse_buffer() - parse a buffer, dropping the diagnostics of the
+ * previous one. The buffer does not need to end with a NUL and is not used
+ * once parsed.
+ * @parser:	the &Merc_Parser
+ * @buffer:	the content to parse
+ * @length:	the length of the content
+ *
+ * Return: 	the number of diagnostics
+ */
+MERC_API int merc_parse_buffer(Merc_Parser *parser, const char *buffer,
+			       size_t length);
+
+/**
+ * merc_set_events() - set the callbacks called while the next buffers are
+ * parsed.
+ * @parser:	the &Merc_Parser
+ * @events:	the &Merc_Events (copied), or NULL for none
+ */
+MERC_API void merc_set_events(Merc_Parser *parser, const Merc_Events *events);
+
+/**
+ * merc_next_diagnostic() - get the next diagnostic of the last buffer parsed,
+ * in the order ./parse prints them.
+ * @parser:	the &Merc_Parser
+ * @diagnostic:	filled with the diagnostic
+ *
+ * Return: 	1 if @diagnostic was filled, 0 if there is none left
+ */
+MERC_API int merc_next_diagnostic(Merc_Parser *parser,
+				  Merc_Diagnostic *diagnostic);
+
+/**
+ * merc_reset_parser() - drop the diagnostics of the last buffer parsed,
+ * keeping the memory of the parser for the next one.
+ * @parser:	the &Merc_Parser
+ */
+MERC_API void merc_reset_parser(Merc_Parser *parser);
+
+/**
+ * merc_non_terminal_name() - get the name of a non-terminal.
+ * @non_terminal:	the non-terminal of an event
+ *
+ * Return: 	the name (e.g. "<while_statement>")
+ */
+MERC_API const char *merc_non_terminal_name(int non_terminal);
+
+/**
+ * merc_token_kind_name() - get the name of a kind of token.
+ * @kind:	the kind of an accepted token
+ *
+ * Return: 	the name (e.g. "VARIABLE")
+ */
+MERC_API const char *merc_token_kind_name(int kind);
+
+/**
+ * merc_free_parser() - free the parser.
+ * @parser:	the &Merc_Parser
+ */
+MERC_API void merc_free_parser(Merc_Parser *parser);
+
+typedef struct merc_document Merc_Document;
+
+/**
+ * merc_create_document() - create an empty document, parsed with the defaults
+ * of ./parse.
+ *
+ * Return: 	the &Merc_Document, or NULL if the token definitions could not
+ * 		be set up
+ */
+MERC_API Merc_Document *merc_create_document(void);
+
+/**
+ * merc_document_parse() - replace the content of the document and parse it
+ * from scratch. The content is copied.
+ * @document:	the &Merc_Document
+ * @content:	the new content
+ * @length:	the length of the content
+ *
+ * Return: 	the number of diagnostics
+ */
+MERC_API int merc_document_parse(Merc_Document *document, const char *content,
+				 size_t length);
+
+/**
+ * merc_document_edit() - replace a range of the content of the document and
+ * parse it again.
+ * @document:		the &Merc_Document
+ * @start:		the offset where the range starts
+ * @end:		the offset where the range ends (excluded)
+ * @replacement:	the content replacing the range (copied)
+ * @length:		the length of the replacement
+ *
+ * Return: 	the number of diagnostics, -1 if the range is out of the
+ * 		document (which is then left as it was)
+ */
+MERC_API int merc_document_edit(Merc_Document *document, size_t start,
+				size_t end, const char *replacement,
+				size_t length);
+
+/**
+ * merc_document_next_diagnostic() - get the next diagnostic of the last parse
+ * of the document, in the order a full parse gives them. The diagnostic is
+ * valid until the next parse.
+ * @document:	the &Merc_Document
+ * @diagnostic:	filled with the diagnostic
+ *
+ * Return: 	1 if @diagnostic was filled, 0 if there is none left
+ */
+MERC_API int merc_document_next_diagnostic(Merc_Document *document,
+					   Merc_Diagnostic *diagnostic);
+
+/**
+ * merc_free_document() - free the document.
+ * @document:	the &Merc_Document
+ */
+MERC_API void merc_free_document(Merc_Document *document);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MERC_H */
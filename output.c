@@ -0,0 +1,102 @@
+#include "output.h"
+#include "setting.h"
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+void init_output(Output *output, FILE *file)
+{
+	output->buffer = NULL;
+	output->length = 0;
+	output->capacity = 0;
+	output->file = file;
+	output->record_count = 0;
+}
+
+static void reserve_output(Output *output, size_t length)
+{
+	if (output->length + length < output->capacity)
+		return;
+	while (output->length + length >= output->capacity)
+		output->capacity = output->capacity * 2 + OUTPUT_BUFFER_SIZE;
+	output->buffer = (char *)realloc(output->buffer, output->capacity);
+}
+
+static void check_output_size(Output *output)
+{
+	if (output->file && output->length >= OUTPUT_FLUSH_SIZE)
+		flush_output(output, output->file);
+}
+
+void output_printf(Output *output, const char *format, ...)
+{
+	va_list args;
+	reserve_output(output, 0);
+	va_start(args, format);
+	int length = vsnprintf(output->buffer + output->length,
+			       output->capacity - output->length, format, args);
+	va_end(args);
+	/* retry once the buffer has room for the whole message */
+	if (output->length + length >= output->capacity) {
+		reserve_output(output, length + 1);
+		va_start(args, format);
+		vsnprintf(output->buffer + output->length,
+			  output->capacity - output->length, format, args);
+		va_end(args);
+	}
+	output->length += length;
+	check_output_size(output);
+}
+
+void output_write(Output *output, const char *data, size_t length)
+{
+	reserve_output(output, length);
+	memcpy(output->buffer + output->length, data, length);
+	output->length += length;
+	check_output_size(output);
+}
+
+void output_json_string(Output *output, const char *value, size_t length)
+{
+	/* worst case of every byte escaped as \u00XX */
+	reserve_output(output, length * 6 + 2);
+	char *end = output->buffer + output->length;
+	*end++ = '"';
+	for (size_t i = 0; i < length; ++i) {
+		unsigned char c = (unsigned char)value[i];
+		if (c == '"' || c == '\\') {
+			*end++ = '\\';
+			*end++ = c;
+		} else if (c < 0x20) {
+			end += sprintf(end, "\\u%04x", c);
+		} else {
+			*end++ = c;
+		}
+	}
+	*end++ = '"';
+	output->length = end - output->buffer;
+	check_output_size(output);
+}
+
+void flush_output(Output *output, FILE *file)
+{
+	if (output->length)
+		fwrite(output->buffer, 1, output->length, file);
+	output->length = 0;
+}
+
+void reset_output(Output *output)
+{
+	output->length = 0;
+	output->record_count = 0;
+}
+
+void clean_output(Output *output)
+{
+	if (output->file) {
+		flush_output(output, output->file);
+		fflush(output->file);
+	}
+	free(output->buffer);
+	init_output(output, output->file);
+}
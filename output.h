@@ -0,0 +1,81 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/* format of the diagnostics, text being the colored human-readable messages */
+enum output_format { OUTPUT_TEXT, OUTPUT_JSONL, OUTPUT_SARIF };
+
+/**
+ * struct output (Output) - a growable buffer collecting the messages of the
+ * parser before they are written out.
+ * @buffer:	the buffered content
+ * @length:	the length of the buffered content
+ * @capacity:	the allocated size of @buffer
+ * @file:	the file the buffer is flushed into once it grows past
+ * 		OUTPUT_FLUSH_SIZE, or NULL to keep everything buffered
+ * @record_count:	the number of diagnostic records written in a
+ * 			machine-readable format (see &enum output_format)
+ */
+typedef struct output {
+	char *buffer;
+	size_t length;
+	size_t capacity;
+	FILE *file;
+	size_t record_count;
+} Output;
+
+/**
+ * init_output() - initialize an empty output.
+ * @output:	the &Output
+ * @file:	the file to flush into when the buffer is full, or NULL
+ */
+void init_output(Output *output, FILE *file);
+
+/**
+ * output_printf() - append a formatted message to the output.
+ * @output:	the &Output
+ * @format:	the printf() format of the message
+ */
+void output_printf(Output *output, const char *format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+/**
+ * output_write() - append raw content to the output.
+ * @output:	the &Output
+ * @data:	the content
+ * @length:	the length of the content
+ */
+void output_write(Output *output, const char *data, size_t length);
+
+/**
+ * output_json_string() - append a string as a quoted JSON string.
+ * @output:	the &Output
+ * @value:	the string
+ * @length:	the length of the string
+ */
+void output_json_string(Output *output, const char *value, size_t length);
+
+/**
+ * flush_output() - write the buffered content into a file and empty the
+ * buffer.
+ * @output:	the &Output
+ * @file:	the file to write into
+ */
+void flush_output(Output *output, FILE *file);
+
+/**
+ * reset_output() - discard the buffered content, keeping the buffer.
+ * @output:	the &Output
+ */
+void reset_output(Output *output);
+
+/**
+ * clean_output() - flush the output into its file (if any) and free the
+ * buffer.
+ * @output:	the &Output
+ */
+void clean_output(Output *output);
+
+#endif /* OUTPUT_H */
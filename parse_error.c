@@ -1,90 +1,206 @@
 #include "parse_error.h"
+#include "context.h"
+#include "incremental.h"
 #include "setting.h"
+#include "stats.h"
+#include "token_table.h"
 #include <stdio.h>
-#include <stdlib.h>
 #include <string.h>
 
-Parse_Error *error_list = NULL;
-int error_junk_after_program_end = 0;
-int error_unexpected_eof = 0;
+const char *error_id_names[] = {"cannot-open-file",
+				"unknown-token",
+				"lexeme-too-long",
+				"unexpected-token",
+				"unexpected-eof",
+				"junk-after-program-end",
+				NULL};
 
-void add_error(char *message, int line_number, int start_col, int end_col)
+void add_error(Parse_Context *context, int id, Token_Set expected,
+	       char *message, int line_number, int start_col, int end_col)
 {
-	/* create Parse_Error and add to the end of the error list */
-	Parse_Error *new_error = (Parse_Error *)malloc(sizeof(Parse_Error));
-	char *message_copy = (char *)malloc(strlen(message) + 1);
-	strcpy(message_copy, message);
-	new_error->message = message_copy;
+	if (context->document) {
+		add_document_error(context, id, expected, message, line_number,
+				   start_col, end_col);
+		return;
+	}
+	/* the lexical errors are kept until the syntax analyzer gets there */
+	if (context->token_stream.state == STREAM_FILLING) {
+		add_stream_error(context, id, message, line_number, start_col,
+				 end_col);
+		return;
+	}
+	/* the lexer thread has them added by the syntax analyzer */
+	if (context->lexer_queue) {
+		queue_error(context, id, message, line_number, start_col,
+			    end_col);
+		return;
+	}
+	/* past the --max-errors budget, nothing more is reported */
+	if (context->has_given_up)
+		return;
+	stats_add(STATS_ERRORS, 1);
+	/* create Parse_Error in the arena and add to the end of the error
+	 * list */
+	Parse_Error *new_error = (Parse_Error *)arena_alloc(
+	    &context->error_arena, sizeof(Parse_Error));
+	new_error->message =
+	    arena_strndup(&context->error_arena, message, strlen(message));
 	new_error->line_number = line_number;
 	new_error->start_col = start_col;
 	new_error->end_col = end_col;
+	new_error->id = id;
+	new_error->expected = expected;
 	new_error->next = NULL;
-	print_error(new_error);
-	if (!error_list) {
-		error_list = new_error;
-	} else {
-		Parse_Error *current = error_list;
-		while (current->next) {
-			current = current->next;
-		}
-		current->next = new_error;
+	print_error(context, new_error);
+	if (!context->error_list)
+		context->error_list = new_error;
+	else
+		context->error_tail->next = new_error;
+	context->error_tail = new_error;
+	if (++context->error_count == context->options.max_errors)
+		context->has_given_up = 1;
+}
+
+static void print_expected(Output *out, Token_Set expected)
+{
+	output_write(out, "[", 1);
+	for (int kind = 0, count = 0; kind < TOKEN_KIND_COUNT; ++kind) {
+		if (expected & TOKEN_BIT(kind))
+			output_printf(out, "%s\"%s\"", count++ ? "," : "",
+				      token_kind_names[kind]);
 	}
+	output_write(out, "]", 1);
 }
 
-void remove_error()
+/* print an error as a JSON object, a NULL @error being an error about the
+ * whole file */
+static void print_record(Parse_Context *context, int id, char *message,
+			 Parse_Error *error)
 {
-	if (error_list) {
-		/* iterate to the end of the error list */
-		Parse_Error *current = error_list;
-		if (current->next) {
-			Parse_Error *prev;
-			while (current->next) {
-				prev = current;
-				current = current->next;
-			}
-			prev->next = NULL;
-		} else {
-			error_list = NULL;
+	Output *out = &context->out;
+	if (context->options.format == OUTPUT_JSONL) {
+		output_printf(out, "{\"file\":");
+		output_json_string(out, context->file_name,
+				   strlen(context->file_name));
+		if (!error)
+			output_printf(out, ",\"line\":null,\"column\":null");
+		else
+			output_printf(out, ",\"line\":%d,\"column\":%d",
+				      error->line_number, error->start_col + 1);
+		if (!error || END_OF_LINE_COL == error->end_col)
+			output_printf(out, ",\"end_column\":null");
+		else
+			output_printf(out, ",\"end_column\":%d",
+				      error->end_col + 1);
+		output_printf(out, ",\"id\":\"%s\",\"message\":",
+			      error_id_names[id]);
+		output_json_string(out, message, strlen(message));
+		output_printf(out, ",\"expected\":");
+		print_expected(out, error ? error->expected : 0);
+		output_write(out, "}\n", 2);
+	} else {
+		/* a SARIF result, the results of all the files being in a
+		 * single array */
+		output_printf(out, "%s\n{\"ruleId\":\"%s\",\"level\":"
+				   "\"error\",\"message\":{\"text\":",
+			      out->record_count ? "," : "", error_id_names[id]);
+		output_json_string(out, message, strlen(message));
+		output_printf(out, "},\"locations\":[{\"physicalLocation\":{"
+				   "\"artifactLocation\":{\"uri\":");
+		output_json_string(out, context->file_name,
+				   strlen(context->file_name));
+		output_write(out, "}", 1);
+		if (error) {
+			output_printf(out, ",\"region\":{\"startLine\":%d,"
+					   "\"startColumn\":%d",
+				      error->line_number, error->start_col + 1);
+			if (END_OF_LINE_COL != error->end_col)
+				output_printf(out, ",\"endColumn\":%d",
+					      error->end_col + 1);
+			output_write(out, "}", 1);
 		}
-		/* deallocation the error */
-		free(current->message);
-		free(current);
-		current = NULL;
+		output_printf(out, "}}],\"properties\":{\"expected\":");
+		print_expected(out, error ? error->expected : 0);
+		output_write(out, "}}", 2);
 	}
+	++out->record_count;
 }
-void print_error(Parse_Error *error)
+
+void print_error(Parse_Context *context, Parse_Error *error)
 {
-	/* if the error end column is specified as MAX_LINE_LENGTH + 1, which is
-	 * impossible to reach, the end position is not printed*/
-	if ((MAX_LINE_LENGTH + 1) == error->end_col) {
-		printf("%s%s [%d:%d]%s\n", ERROR_COL, error->message,
-		       error->line_number, error->start_col + 1, COL_RESET);
+	if (context->options.format != OUTPUT_TEXT) {
+		print_record(context, error->id, error->message, error);
+		return;
+	}
+	/* if the error end column is specified as END_OF_LINE_COL, the end
+	 * position is not printed*/
+	if (END_OF_LINE_COL == error->end_col) {
+		output_printf(&context->out, "%sERROR - %s [%d:%d]%s\n",
+			      ERROR_COL, error->message, error->line_number,
+			      error->start_col + 1, COL_RESET);
 	} else {
 		/* add 1 to column position to make column start from 1 instead
 		 * of 0 */
-		printf("%s%s [%d:%d-%d]%s\n", ERROR_COL, error->message,
-		       error->line_number, error->start_col + 1,
-		       error->end_col + 1, COL_RESET);
+		output_printf(&context->out, "%sERROR - %s [%d:%d-%d]%s\n",
+			      ERROR_COL, error->message, error->line_number,
+			      error->start_col + 1, error->end_col + 1,
+			      COL_RESET);
 	}
 }
 
-void print_error_list()
+void print_file_error(Parse_Context *context, int id, char *message)
 {
-	if (error_list) {
+	if (context->options.format != OUTPUT_TEXT)
+		print_record(context, id, message, NULL);
+	else
+		output_printf(&context->out, "%sERROR - %s: %s%s\n", ERROR_COL,
+			      message, context->file_name, COL_RESET);
+}
+
+void print_error_list(Parse_Context *context)
+{
+	if (context->error_list) {
 		/* iteratively print error in the list */
-		for (Parse_Error *current = error_list; current;
+		for (Parse_Error *current = context->error_list; current;
 		     current = current->next)
-			print_error(current);
+			print_error(context, current);
 	}
 }
 
-void clean_error_list()
+void print_report_header(Output *out, int format)
+{
+	if (format != OUTPUT_SARIF)
+		return;
+	output_printf(out, "{\"version\":\"2.1.0\",\"$schema\":\"https://"
+			   "json.schemastore.org/sarif-2.1.0.json\",\"runs\":[{"
+			   "\"tool\":{\"driver\":{\"name\":\"Mer-C-less\","
+			   "\"rules\":[");
+	for (int id = 0; id < ERROR_ID_COUNT; ++id)
+		output_printf(out, "%s{\"id\":\"%s\"}", id ? "," : "",
+			      error_id_names[id]);
+	output_printf(out, "]}},\"results\":[");
+}
+
+void print_report_footer(Output *out, int format)
+{
+	if (format == OUTPUT_SARIF)
+		output_printf(out, "\n]}]}\n");
+}
+
+void reset_error_list(Parse_Context *context)
+{
+	reset_arena(&context->error_arena);
+	context->error_list = NULL;
+	context->error_tail = NULL;
+}
+
+void clean_error_list(Parse_Context *context)
 {
 #if defined(DEBUG) && defined(PARSE_DEBUG_ENABLED)
 	printf("%sCleaning up parse error list%s\n", INFO_COL, COL_RESET);
 #endif
-	/* iteratively remove error from in the list */
-	while (error_list) {
-		remove_error();
-	}
-}
\ No newline at end of file
+	/* the errors are all released with their arena */
+	clean_arena(&context->error_arena);
+	context->error_list = NULL;
+	context->error_tail = NULL;
+}
@@ -1,12 +1,38 @@
 #ifndef PARSE_ERROR_H
 #define PARSE_ERROR_H
 
+#include "lexical.h"
+#include "output.h"
+#include <limits.h>
+
+/* end column of an error running to the end of its line, the end position of
+ * such an error is not printed */
+#define END_OF_LINE_COL INT_MAX
+
+/* identifier of each kind of error, stable across releases so that tools can
+ * rely on it (see error_id_names) */
+enum error_id {
+	ERROR_CANNOT_OPEN_FILE,
+	ERROR_UNKNOWN_TOKEN,
+	ERROR_LEXEME_TOO_LONG,
+	ERROR_UNEXPECTED_TOKEN,
+	ERROR_UNEXPECTED_EOF,
+	ERROR_JUNK_AFTER_PROGRAM_END,
+	ERROR_ID_COUNT
+};
+
+/* name of each error identifier */
+extern const char *error_id_names[];
+
 /**
  * struct parse_error (Parse_Error) - store information of a parser error
- * (currently being implemented as a linked list node).
+ * (currently being implemented as a linked list node allocated in the error
+ * arena of the &Parse_Context).
  * @line_number:	the line where error occurs
  * @start_col:		the column where the error starts
  * @end_col:		the column where the error ends
+ * @id:			the kind of error (see &enum error_id)
+ * @expected:		the kinds of tokens that were expected, if any
  * @message:		the error message
  * @next:		pointer to the next error in the error list
  */
@@ -14,45 +40,77 @@ typedef struct parse_error {
 	int line_number;
 	int start_col;
 	int end_col;
+	int id;
+	Token_Set expected;
 	char *message;
 	struct parse_error *next;
 } Parse_Error;
 
-/* the error list */
-extern Parse_Error *error_list;
-/* boolean indicates if junk after program end was detected */
-extern int error_junk_after_program_end;
-/* boolean indicates if unexpected EOF was detected */
-extern int error_unexpected_eof;
+/* defined in context.h */
+typedef struct parse_context Parse_Context;
 
 /**
  * add_error() - create error, print it and add to the end of the error list.
- * @message:		the error message
+ * @context:		the &Parse_Context
+ * @id:			the kind of error (see &enum error_id)
+ * @expected:		the kinds of tokens that were expected, or 0
+ * @message:		the error message (without the "ERROR - " prefix)
  * @line_number:	the line where error occurs
  * @start_col:		the column where the error starts
  * @end_col:		the column where the error ends
  */
-void add_error(char *message, int line_number, int start_col, int end_col);
+void add_error(Parse_Context *context, int id, Token_Set expected,
+	       char *message, int line_number, int start_col, int end_col);
 
 /**
- * remove_error() - remove the error at the end of the error list.
+ * print_file_error() - print an error about a whole file (e.g. it cannot be
+ * opened), which is not added to the error list.
+ * @context:	the &Parse_Context
+ * @id:		the kind of error (see &enum error_id)
+ * @message:	the error message (without the "ERROR - " prefix)
  */
-void remove_error(void);
+void print_file_error(Parse_Context *context, int id, char *message);
 
 /**
  * print_error() - print the error.
+ * @context:	the &Parse_Context
  * @error:	the &Parse_Error error
  */
-void print_error(Parse_Error *error);
+void print_error(Parse_Context *context, Parse_Error *error);
 
 /**
  * print_error_list() - print the list of error.
+ * @context:	the &Parse_Context
+ */
+void print_error_list(Parse_Context *context);
+
+/**
+ * print_report_header() - print what comes before the diagnostics of all the
+ * files in the given format.
+ * @out:	the &Output
+ * @format:	the format of the diagnostics (see &enum output_format)
+ */
+void print_report_header(Output *out, int format);
+
+/**
+ * print_report_footer() - print what comes after the diagnostics of all the
+ * files in the given format.
+ * @out:	the &Output
+ * @format:	the format of the diagnostics (see &enum output_format)
+ */
+void print_report_footer(Output *out, int format);
+
+/**
+ * reset_error_list() - empty the error list, keeping the memory of its arena
+ * for the next input.
+ * @context:	the &Parse_Context
  */
-void print_error_list(void);
+void reset_error_list(Parse_Context *context);
 
 /**
- * clean_error_list() - cleanup the error list.
+ * clean_error_list() - cleanup the error list, releasing its arena at once.
+ * @context:	the &Parse_Context
  */
-void clean_error_list(void);
+void clean_error_list(Parse_Context *context);
 
 #endif /* PARSE_ERROR_H */
\ No newline at end of file
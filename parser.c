@@ -1,195 +1,167 @@
 #include "parser.h"
+#include "code_display.h"
 #include "lexical.h"
 #include "setting.h"
+#include "stats.h"
 #include "syntax.h"
+#include "syntax_table.h"
+#include <stdint.h>
 #include <stdio.h>
-#include <stdlib.h>
+#include <time.h>
 
-extern FILE *input_file;
-extern Parse_Error *error_list;
-extern int error_junk_after_program_end;
-extern int error_unexpected_eof;
-extern int has_tab_space;
-
-/* main driver */
-int main(int argc, char **argv)
+int parse_file(Parse_Context *context, char *file_name)
 {
-#ifdef DEBUG
-	printf("%sDEBUG MODE ENABLED%s\n", DEBUG_COL, COL_RESET);
-#endif
-	int return_value = 0;
-	return_value = get_token_definitions();
-
-	/* check token definition file is loaded properly */
-	if (return_value)
-		return -2;
+	/* check if the input is loaded properly */
+	if (load_input(context, file_name))
+		return -1;
+	return parse_input(context);
+}
 
-	/* check if the argument indicating the input file is specfied */
-	if (argc < 2) {
-		printf("You must supply the input file name "
-		       "on the command line\n");
-		exit(EXIT_FAILURE);
+int parse_input(Parse_Context *context)
+{
+	/* only the errors are reported in the machine-readable formats */
+	int is_text = context->options.format == OUTPUT_TEXT;
+	/* the AST refers to the input by 32-bit offsets */
+	if (context->options.ast_mode &&
+	    context->lexer.input.length > UINT32_MAX) {
+		if (is_text)
+			output_printf(&context->out,
+				      "%sWARNING - input too large to build its "
+				      "AST%s\n",
+				      WARNING_COL, COL_RESET);
+		context->options.ast_mode = AST_MODE_NONE;
 	}
 
-	/* check if the input is loaded properly */
-	++argv;
-	return_value = load_input(*argv);
-	if (return_value != 0)
-		exit(EXIT_FAILURE);
-
 	/* run the parser */
-	parse();
+	if (context->options.lex_mode == LEX_MODE_ONLY ||
+	    context->options.lex_mode == LEX_MODE_ONLY_FIRST)
+		lex_only(context);
+	else
+		parse(context);
+
+	if (is_text && context->options.ast_mode == AST_MODE_SUMMARY)
+		output_printf(&context->out,
+			      "%sINFO - AST of %u node(s) (%zu byte(s))%s\n",
+			      INFO_COL, context->ast.node_count,
+			      context->ast.node_count * sizeof(Ast_Node),
+			      COL_RESET);
+	else if (is_text && context->options.ast_mode == AST_MODE_TREE)
+		print_ast(&context->ast, &context->out,
+			  context->lexer.input.content);
+	if (is_text && context->options.symbols)
+		print_symbol_table(&context->symbols, &context->out);
+
+	if (is_text && context->has_given_up)
+		output_printf(&context->out,
+			      "%sWARNING - gave up after %d error(s) (see "
+			      "--max-errors)%s\n",
+			      WARNING_COL, context->error_count, COL_RESET);
 
 #ifndef DISABLE_TAB_SIZE_WARNING
 #if TAB_SIZE_WARNING_ENABLED == 1
 	/* print warning about tab usage as if the TAB_SIZE option and the tab
 	 * size used by the source code is different, then the error location
 	 * information will be off */
-	if (error_list && has_tab_space)
-		printf("%sWARNING - detect usage of tab(s), column location "
-		       "might be off since a tab is currently counted as %d "
-		       "space(s) (check TAB_SIZE option in setting.h)%s\n",
-		       WARNING_COL, TAB_SIZE, COL_RESET);
+	if (is_text && context->error_list && context->lexer.has_tab_space)
+		output_printf(&context->out,
+			      "%sWARNING - detect usage of tab(s), column "
+			      "location might be off since a tab is currently "
+			      "counted as %d space(s) (check TAB_SIZE option in "
+			      "setting.h)%s\n",
+			      WARNING_COL, TAB_SIZE, COL_RESET);
 #endif
 #endif
 
 #if SUCCESS_DISPLAY_ENABLED == 1
 	/* print success message if no error was found */
-	if (!error_list)
-		printf("%sSUCCESS - completed parsing with no errors%s\n",
-		       SUCCESS_COL, COL_RESET);
+	if (is_text && !context->error_list)
+		output_printf(&context->out,
+			      "%sSUCCESS - completed parsing with no errors%s\n",
+			      SUCCESS_COL, COL_RESET);
 #endif
 
 #ifndef DISABLE_SOURCE_DISPLAY
 #if CODE_DISPLAY_ENABLED == 1
 	/* error matching for source code */
-	if (error_list) {
-		load_input(*argv);
-		printf("%s%s%s\n", DEBUG_COL, *argv, COL_RESET);
-		code_display();
+	if (is_text && context->error_list) {
+		output_printf(&context->out, "%s%s%s\n", DEBUG_COL,
+			      context->file_name, COL_RESET);
+		uint64_t start = stats_start();
+		code_display(context);
+		stats_stop(STATS_CODE_DISPLAY, start);
 	}
 #endif
 #endif
-	/* cleanup the mess the parser left behind */
-	cleanup();
-	exit(EXIT_SUCCESS);
-}
-
-void parse()
-{
-	program();
+	int has_error = context->error_list != NULL;
+	uint64_t start = stats_start();
+	cleanup(context);
+	stats_stop(STATS_CLEANUP, start);
+	/* the counts of the input are added to the totals by the thread
+	 * parsing it */
+	stats_flush();
+	return has_error;
 }
 
-void lex_only()
+void parse(Parse_Context *context)
 {
-	Lex_Token *lex_token;
-	do {
-		lex_token = lex();
-	} while (lex_token != NULL);
+	/* the time of lex() is taken off the time of the syntax analysis */
+	uint64_t lex_time = thread_stats.timers[STATS_LEX];
+	uint64_t start = stats_start();
+	/* the tokens are then read from the token stream */
+	if (context->options.lex_mode == LEX_MODE_FIRST)
+		fill_token_stream(context);
+	/* or from the queue the lexer thread fills meanwhile */
+	else if (context->options.lex_mode == LEX_MODE_PIPELINED)
+		start_pipeline(context);
+	if (context->options.engine == ENGINE_TABLE)
+		table_parse(context);
+	else
+		program(context);
+	stop_pipeline(context);
+	if (context->options.ast_mode)
+		ast_finish(&context->ast);
+	stats_stop(STATS_PARSE,
+		   start + (thread_stats.timers[STATS_LEX] - lex_time));
 }
 
-void code_display()
+void lex_only(Parse_Context *context)
 {
-	int current_char;
-	int has_error;
-	int current_line = 1;
-	int current_col = -1;
-	Parse_Error *error = error_list;
-	int *has_reached_error_list_end = (int *)malloc(sizeof(int));
-	*has_reached_error_list_end = 0;
-	if (input_file) {
-		while ((current_char = getc(input_file)) != EOF) {
-			/* check the current character and modify current_line
-			 * and current_col */
-			if (current_char == '\n') {
-				current_line++;
-				current_col = -1;
-			} else if (current_char == '\t') {
-				current_col += TAB_SIZE;
-			} else {
-				current_col++;
-			}
-
-			/* check for error in the current cell */
-			has_error = check_code_error_from_list(
-			    &error, has_reached_error_list_end, current_line,
-			    current_col);
-
-			/* decorate character to be printed in error matched
-			 * source code */
-			if (!has_error) {
-				printf("%c", current_char);
-			} else if (current_char == '\n') {
-				printf("%s %c%s", CODE_DISPLAY_ERROR_COL,
-				       current_char, COL_RESET);
-			} else {
-				printf("%s%c%s", CODE_DISPLAY_ERROR_COL,
-				       current_char, COL_RESET);
-			}
-		}
-	}
-	/* handle unexpected EOF error */
-	Parse_Error *last_error = error_list;
-	while (last_error->next) {
-		last_error = last_error->next;
+	struct timespec start, end;
+	size_t token_count = 0;
+	int is_stream = context->options.lex_mode == LEX_MODE_ONLY_FIRST;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	if (is_stream && !fill_token_stream(context)) {
+		token_count = context->token_stream.count;
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		/* read the stream only for its lexical errors */
+		while (lex(context))
+			;
+	} else {
+		/* the tokens are lexed as the syntax analyzer would get them,
+		 * so that the time of the syntax analysis is what parsing adds
+		 * to it */
+		is_stream = 0;
+		while (lex(context))
+			++token_count;
+		clock_gettime(CLOCK_MONOTONIC, &end);
 	}
-	if (error_unexpected_eof) {
-		printf("%s%c%s", CODE_DISPLAY_ERROR_COL, ' ', COL_RESET);
-	}
-	printf("\n");
-
-	/* cleanup */
-	free(has_reached_error_list_end);
-	has_reached_error_list_end = NULL;
-	fclose(input_file);
+	double seconds =
+	    (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	if (context->options.format == OUTPUT_TEXT)
+		output_printf(&context->out,
+			      "%sINFO - lexed %zu token(s)%s in %.3f ms (%.0f "
+			      "token(s)/s)%s\n",
+			      INFO_COL, token_count,
+			      is_stream ? " into the token stream" : "",
+			      seconds * 1e3,
+			      seconds > 0 ? token_count / seconds : 0.0,
+			      COL_RESET);
 }
 
-void cleanup()
+void cleanup(Parse_Context *context)
 {
-	clean_lex();
-	clean_error_list();
+	unload_input(&context->lexer);
+	context->token_stream.state = STREAM_OFF;
+	/* the arena is kept for the next input parsed with the context */
+	reset_error_list(context);
 }
-
-int check_code_error_from_list(Parse_Error **error,
-			       int *has_reached_error_list_end,
-			       int current_line, int current_col)
-{
-	if (*has_reached_error_list_end && error_junk_after_program_end) {
-		return 1;
-	}
-	if (*has_reached_error_list_end)
-		return 0;
-	/* make sure no error is marked if the error line is not reached */
-	if ((*error)->line_number > current_line)
-		return 0;
-	/* get to the error line */
-	while ((*error)->line_number < current_line) {
-		if (!(*error)->next) {
-			*has_reached_error_list_end = 1;
-			return 0;
-		} else {
-			error = &((*error)->next);
-		}
-	}
-	/* try to reach error column */
-	while (((*error)->end_col - 1) < current_col) {
-		if (!(*error)->next) {
-			/* no more error */
-			*has_reached_error_list_end = 1;
-			return 0;
-		} else if (current_line < (*error)->next->line_number) {
-			/* no more error on the current line */
-			return 0;
-		} else {
-			error = &((*error)->next);
-		}
-	}
-	/* make sure the current cell falls within the bound of the error */
-	if (current_line == (*error)->line_number) {
-		if (((*error)->end_col - 1) < current_col)
-			return 0;
-		if ((*error)->start_col <= current_col)
-			return 1;
-	}
-	return 0;
-}
\ No newline at end of file
@@ -1,40 +1,48 @@
 #ifndef PARSER_H
 #define PARSER_H
 
-#include "parse_error.h"
+#include "context.h"
 
 /**
- * parse() - run the syntax analyzer.
+ * parse_file() - parse a file and print its errors, warnings and error
+ * matching source code.
+ * @context: 	the &Parse_Context
+ * @file_name: 	name of the file
+ *
+ * Return: 	0: success
+ * 		1: the file has error(s)
+ * 		-1: file not found
  */
-void parse(void);
+int parse_file(Parse_Context *context, char *file_name);
 
 /**
- * lex_only() - only run the lexical analyzer.
+ * parse_input() - parse the input already loaded in the context and print its
+ * errors, warnings and error matching source code.
+ * @context: 	the &Parse_Context
+ *
+ * Return: 	0: success
+ * 		1: the input has error(s)
  */
-void lex_only(void);
+int parse_input(Parse_Context *context);
 
 /**
- * code_display() - conduct and print error matching for the source code.
+ * parse() - run the syntax analyzer.
+ * @context: 	the &Parse_Context
  */
-void code_display(void);
+void parse(Parse_Context *context);
 
 /**
- * check_code_error_from_list() - check if the current position has any error
- * @error: 			pointer to the current error in the error list
- * @has_reached_error_list_end: boolean indicates if the end of the rror list is reached
- * @current_line:		the current line of the source code
- * @current_col:		the current column of the source code
- *
- * Return: 			0: no error
- * 				1: has error
+ * lex_only() - only run the lexical analyzer, reporting the lexical errors and
+ * how fast the tokens were found, one at a time or into the &Token_Stream
+ * (LEX_MODE_ONLY_FIRST).
+ * @context: 	the &Parse_Context
  */
-int check_code_error_from_list(Parse_Error **error,
-			       int *has_reached_error_list_end,
-			       int current_line, int current_col);
+void lex_only(Parse_Context *context);
 
 /**
  * cleanup() - cleanup the parser leftover.
+ * @context: 	the &Parse_Context
  */
-void cleanup(void);
+void cleanup(Parse_Context *context);
 
 #endif /* PARSER_H */
\ No newline at end of file
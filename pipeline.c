@@ -0,0 +1,176 @@
+#include "pipeline.h"
+#include "context.h"
+#include "stats.h"
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* how many times a thread checks the other one again before yielding */
+#define QUEUE_SPIN_COUNT 64
+
+/* wait a little for the other thread */
+static void wait_turn(unsigned int *spins)
+{
+	if (++*spins < QUEUE_SPIN_COUNT) {
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_ia32_pause();
+#endif
+		return;
+	}
+	/* the other thread may be waiting for the CPU we hold */
+	*spins = 0;
+	sched_yield();
+}
+
+/* add an entry at the tail of the queue, waiting for room if it is full
+ * (return -1 if the lexer thread has to stop instead) */
+static int push_entry(Token_Queue *queue, const Queued_Token *entry)
+{
+	size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+	unsigned int spins = 0;
+	while (tail - queue->cached_head == TOKEN_QUEUE_SIZE) {
+		queue->cached_head =
+		    atomic_load_explicit(&queue->head, memory_order_acquire);
+		if (tail - queue->cached_head < TOKEN_QUEUE_SIZE)
+			break;
+		if (atomic_load_explicit(&queue->stop, memory_order_relaxed))
+			return -1;
+		wait_turn(&spins);
+	}
+	queue->entries[tail & (TOKEN_QUEUE_SIZE - 1)] = *entry;
+	atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+	return 0;
+}
+
+/* take the entry at the head of the queue, waiting for it if it is empty (the
+ * lexer thread always ends with a QUEUED_END) */
+static void pop_entry(Token_Queue *queue, Queued_Token *entry)
+{
+	size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+	unsigned int spins = 0;
+	while (head == queue->cached_tail) {
+		queue->cached_tail =
+		    atomic_load_explicit(&queue->tail, memory_order_acquire);
+		if (head != queue->cached_tail)
+			break;
+		wait_turn(&spins);
+	}
+	*entry = queue->entries[head & (TOKEN_QUEUE_SIZE - 1)];
+	atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+}
+
+/* body of the lexer thread */
+static void *lex_ahead(void *arg)
+{
+	Parse_Context *context = (Parse_Context *)arg;
+	Token_Queue *queue = context->lexer_queue;
+	Lexer *lexer = &context->lexer;
+	Queued_Token entry = {.kind = QUEUED_TOKEN};
+	Lex_Token *lex_token;
+	while ((lex_token = lex(context))) {
+		entry.has_tab_space = lexer->has_tab_space;
+		entry.line_number = lexer->line_number;
+		entry.col_number = lexer->col_number;
+		entry.length = lex_token->length;
+		entry.offset = lex_token->offset;
+		entry.token = lex_token->token;
+		if (push_entry(queue, &entry))
+			break;
+	}
+	if (!lex_token) {
+		entry.kind = QUEUED_END;
+		entry.has_tab_space = lexer->has_tab_space;
+		entry.line_number = lexer->line_number;
+		entry.col_number = lexer->col_number;
+		entry.offset = lexer->cursor;
+		push_entry(queue, &entry);
+	}
+	stats_flush();
+	return NULL;
+}
+
+int start_pipeline(Parse_Context *context)
+{
+	/* both threads would take turns on the same core, which only adds the
+	 * cost of the queue (the tests still want the thread, see
+	 * FORCE_PIPELINE in the Makefile) */
+#ifndef FORCE_PIPELINE
+	if (sysconf(_SC_NPROCESSORS_ONLN) < 2)
+		return -1;
+#endif
+	Token_Queue *queue =
+	    (Token_Queue *)aligned_alloc(QUEUE_LINE_SIZE, sizeof(Token_Queue));
+	memset(queue, 0, sizeof(Token_Queue));
+	queue->entries =
+	    (Queued_Token *)malloc(TOKEN_QUEUE_SIZE * sizeof(Queued_Token));
+	/* the lexer thread gets a lexer of its own, the syntax analyzer
+	 * getting the state of the lexer along with the tokens */
+	queue->lexer_context = (Parse_Context *)malloc(sizeof(Parse_Context));
+	*queue->lexer_context = *context;
+	queue->lexer_context->lexer_queue = queue;
+	if (pthread_create(&queue->thread, NULL, lex_ahead,
+			   queue->lexer_context)) {
+		free(queue->lexer_context);
+		free(queue->entries);
+		free(queue);
+		return -1;
+	}
+	context->token_queue = queue;
+	return 0;
+}
+
+void stop_pipeline(Parse_Context *context)
+{
+	Token_Queue *queue = context->token_queue;
+	if (!queue)
+		return;
+	atomic_store_explicit(&queue->stop, 1, memory_order_relaxed);
+	pthread_join(queue->thread, NULL);
+	free(queue->lexer_context);
+	free(queue->entries);
+	free(queue);
+	context->token_queue = NULL;
+}
+
+Lex_Token *next_queued_token(Parse_Context *context)
+{
+	Token_Queue *queue = context->token_queue;
+	Lexer *lexer = &context->lexer;
+	if (queue->at_end)
+		return NULL;
+	Queued_Token entry;
+	/* the lexical errors found on the way come before the token */
+	for (pop_entry(queue, &entry); entry.kind == QUEUED_ERROR;
+	     pop_entry(queue, &entry))
+		add_error(context, entry.length, 0, entry.message,
+			  entry.line_number, entry.col_number, entry.end_col);
+
+	/* the lexer is left as if it had just lexed the token */
+	lexer->has_tab_space = entry.has_tab_space;
+	lexer->line_number = entry.line_number;
+	lexer->col_number = entry.col_number;
+	if (entry.kind == QUEUED_END) {
+		lexer->cursor = entry.offset;
+		queue->at_end = 1;
+		return NULL;
+	}
+	Lex_Token *lex_token = &lexer->lex_token;
+	lex_token->offset = entry.offset;
+	lex_token->length = entry.length;
+	lex_token->token = entry.token;
+	lexer->cursor = entry.offset + entry.length;
+	return lex_token;
+}
+
+void queue_error(Parse_Context *context, int id, char *message,
+		 int line_number, int start_col, int end_col)
+{
+	Queued_Token entry = {.kind = QUEUED_ERROR,
+			      .line_number = line_number,
+			      .col_number = start_col,
+			      .end_col = end_col,
+			      .length = id,
+			      .message = message};
+	push_entry(context->lexer_queue, &entry);
+}
@@ -0,0 +1,136 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "lexical.h"
+#include "setting.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+/*
+ * In the pipelined mode (--pipeline), a lexer thread lexes the input ahead of
+ * the syntax analyzer, handing it the tokens through a bounded ring with a
+ * single producer and a single consumer. The lexical errors go through the
+ * ring too, before the token they came before, so that they are added to the
+ * error list by the syntax analyzer in the same order as when both analyzers
+ * interleave.
+ */
+
+#if TOKEN_QUEUE_SIZE & (TOKEN_QUEUE_SIZE - 1)
+#error "TOKEN_QUEUE_SIZE must be a power of 2"
+#endif
+
+/* the size the fields written by different threads are kept apart by */
+#define QUEUE_LINE_SIZE 64
+
+/* what an entry of the &Token_Queue holds */
+enum queued_kind {
+	/* a token */
+	QUEUED_TOKEN,
+	/* a lexical error */
+	QUEUED_ERROR,
+	/* the end of the input */
+	QUEUED_END
+};
+
+/**
+ * struct queued_token (Queued_Token) - an entry of the &Token_Queue, with the
+ * state of the lexer right after it.
+ * @kind:		what the entry holds (see &enum queued_kind)
+ * @has_tab_space:	boolean indicates if tab usage has been spotted so far
+ * @line_number:	the line of the lexer (of the error if QUEUED_ERROR)
+ * @col_number:		the column of the lexer (where the error starts if
+ * 			QUEUED_ERROR)
+ * @end_col:		where the error ends (QUEUED_ERROR only)
+ * @length:		the length of the lexeme (the &enum error_id of the
+ * 			error if QUEUED_ERROR)
+ * @offset:		the position of the lexeme (of the lexer if
+ * 			QUEUED_END)
+ * @token:		the token the lexeme is associated with
+ * @message:		the error message (QUEUED_ERROR only)
+ */
+typedef struct queued_token {
+	int kind;
+	int has_tab_space;
+	int line_number;
+	int col_number;
+	int end_col;
+	int length;
+	size_t offset;
+	Token *token;
+	char *message;
+} Queued_Token;
+
+/**
+ * struct token_queue (Token_Queue) - the ring between the lexer thread and
+ * the syntax analyzer, the fields each of them writes being on their own
+ * cache line.
+ * @head:		index of the next entry to be read (syntax analyzer)
+ * @cached_tail:	@tail as last seen by the syntax analyzer
+ * @at_end:		boolean indicates if the end of the input was read
+ * @tail:		index of the next entry to be written (lexer thread)
+ * @cached_head:	@head as last seen by the lexer thread
+ * @stop:		boolean indicates if the lexer thread has to stop, the
+ * 			syntax analyzer being done
+ * @entries:		the TOKEN_QUEUE_SIZE entries
+ * @lexer_context:	the copy of the &Parse_Context the lexer thread lexes
+ * 			with
+ * @thread:		the lexer thread
+ *
+ * The indices only grow, an index i being in @entries[i % TOKEN_QUEUE_SIZE].
+ * A full ring makes the lexer thread wait for the syntax analyzer, and an
+ * empty one the other way around.
+ */
+typedef struct token_queue {
+	_Alignas(QUEUE_LINE_SIZE) atomic_size_t head;
+	size_t cached_tail;
+	int at_end;
+	_Alignas(QUEUE_LINE_SIZE) atomic_size_t tail;
+	size_t cached_head;
+	_Alignas(QUEUE_LINE_SIZE) atomic_int stop;
+	Queued_Token *entries;
+	Parse_Context *lexer_context;
+	pthread_t thread;
+} Token_Queue;
+
+/**
+ * start_pipeline() - start the lexer thread on the input of the context,
+ * then have lex() read from the queue.
+ * @context:	the &Parse_Context, with its input loaded
+ *
+ * Return: 	0: success
+ * 		-1: a single core is online or the thread could not be
+ * 		started (lex() then lexes the input as usual)
+ */
+int start_pipeline(Parse_Context *context);
+
+/**
+ * stop_pipeline() - stop the lexer thread once the syntax analysis is over,
+ * wherever it is in the input, and free the queue.
+ * @context:	the &Parse_Context
+ */
+void stop_pipeline(Parse_Context *context);
+
+/**
+ * next_queued_token() - hand the next token of the queue to the syntax
+ * analyzer, as lex() would, after adding the lexical errors before it.
+ * @context:	the &Parse_Context
+ *
+ * Return: 	the next &Lex_Token, or NULL if EOF
+ */
+Lex_Token *next_queued_token(Parse_Context *context);
+
+/**
+ * queue_error() - send a lexical error found by the lexer thread to the
+ * syntax analyzer.
+ * @context:	the &Parse_Context of the lexer thread
+ * @id:		the kind of error (see &enum error_id)
+ * @message:	the error message
+ * @line_number:	the line of the error
+ * @start_col:	the column where the error starts
+ * @end_col:	the column where the error ends
+ */
+void queue_error(Parse_Context *context, int id, char *message,
+		 int line_number, int start_col, int end_col);
+
+#endif /* PIPELINE_H */
@@ -0,0 +1,223 @@
+#include "scan.h"
+#include "setting.h"
+
+/* the SIMD kernels are only built if enabled (see setting.h) */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) &&         \
+    SIMD_SCAN_ENABLED == 1
+#include <immintrin.h>
+#define HAS_X86_KERNELS
+#endif
+
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+
+static ALWAYS_INLINE int has_byte(int set, unsigned char c)
+{
+	switch (set) {
+	case SCAN_BLANK:
+		return c == ' ' || (unsigned char)(c - '\v') < 3;
+	case SCAN_DIGIT:
+		return (unsigned char)(c - '0') < 10;
+	case SCAN_ALNUM:
+		return (unsigned char)(c - '0') < 10 ||
+		       (unsigned char)((c | 0x20) - 'a') < 26;
+	case SCAN_WORD:
+		return (unsigned char)(c - '0') < 10 ||
+		       (unsigned char)((c | 0x20) - 'a') < 26 || c == '_';
+	case SCAN_NOT_NUL:
+		return c != '\0';
+	}
+	return 0;
+}
+
+int scan_has(int set, unsigned char c)
+{
+	return has_byte(set, c);
+}
+
+static ALWAYS_INLINE size_t run_scalar(int set, const char *value,
+				       size_t length)
+{
+	size_t i = 0;
+	while (i < length && has_byte(set, value[i]))
+		++i;
+	return i;
+}
+
+static size_t scan_run_scalar(int set, const char *value, size_t length)
+{
+	switch (set) {
+	case SCAN_BLANK:
+		return run_scalar(SCAN_BLANK, value, length);
+	case SCAN_DIGIT:
+		return run_scalar(SCAN_DIGIT, value, length);
+	case SCAN_ALNUM:
+		return run_scalar(SCAN_ALNUM, value, length);
+	case SCAN_WORD:
+		return run_scalar(SCAN_WORD, value, length);
+	case SCAN_NOT_NUL:
+		return run_scalar(SCAN_NOT_NUL, value, length);
+	}
+	return 0;
+}
+
+#ifdef HAS_X86_KERNELS
+
+/* the bytes c with (unsigned)(c - low) < count, as 0xff */
+static ALWAYS_INLINE __m128i sse2_in_range(__m128i v, char low, char count)
+{
+	__m128i x = _mm_sub_epi8(v, _mm_set1_epi8(low));
+	return _mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8(count - 1)), x);
+}
+
+static ALWAYS_INLINE __m128i sse2_members(int set, __m128i v)
+{
+	__m128i digit = sse2_in_range(v, '0', 10);
+	__m128i alpha =
+	    sse2_in_range(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 26);
+	switch (set) {
+	case SCAN_BLANK:
+		return _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+				    sse2_in_range(v, '\v', 3));
+	case SCAN_DIGIT:
+		return digit;
+	case SCAN_ALNUM:
+		return _mm_or_si128(digit, alpha);
+	case SCAN_WORD:
+		return _mm_or_si128(_mm_or_si128(digit, alpha),
+				    _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+	}
+	/* SCAN_NOT_NUL */
+	return _mm_andnot_si128(_mm_cmpeq_epi8(v, _mm_setzero_si128()),
+				_mm_set1_epi8(-1));
+}
+
+static ALWAYS_INLINE size_t run_sse2(int set, const char *value,
+				     size_t length)
+{
+	/* most runs between two tokens are empty or a single blank */
+	if (!length || !has_byte(set, value[0]))
+		return 0;
+	size_t i = 0;
+	for (; i + 16 <= length; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(value + i));
+		unsigned int outside =
+		    ~_mm_movemask_epi8(sse2_members(set, v)) & 0xffff;
+		if (outside)
+			return i + __builtin_ctz(outside);
+	}
+	return i + run_scalar(set, value + i, length - i);
+}
+
+static size_t scan_run_sse2(int set, const char *value, size_t length)
+{
+	switch (set) {
+	case SCAN_BLANK:
+		return run_sse2(SCAN_BLANK, value, length);
+	case SCAN_DIGIT:
+		return run_sse2(SCAN_DIGIT, value, length);
+	case SCAN_ALNUM:
+		return run_sse2(SCAN_ALNUM, value, length);
+	case SCAN_WORD:
+		return run_sse2(SCAN_WORD, value, length);
+	case SCAN_NOT_NUL:
+		return run_sse2(SCAN_NOT_NUL, value, length);
+	}
+	return 0;
+}
+
+#define AVX2 __attribute__((target("avx2")))
+
+static AVX2 ALWAYS_INLINE __m256i avx2_in_range(__m256i v, char low,
+						 char count)
+{
+	__m256i x = _mm256_sub_epi8(v, _mm256_set1_epi8(low));
+	return _mm256_cmpeq_epi8(_mm256_min_epu8(x, _mm256_set1_epi8(count - 1)),
+				 x);
+}
+
+static AVX2 ALWAYS_INLINE __m256i avx2_members(int set, __m256i v)
+{
+	__m256i digit = avx2_in_range(v, '0', 10);
+	__m256i alpha =
+	    avx2_in_range(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 26);
+	switch (set) {
+	case SCAN_BLANK:
+		return _mm256_or_si256(
+		    _mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+		    avx2_in_range(v, '\v', 3));
+	case SCAN_DIGIT:
+		return digit;
+	case SCAN_ALNUM:
+		return _mm256_or_si256(digit, alpha);
+	case SCAN_WORD:
+		return _mm256_or_si256(
+		    _mm256_or_si256(digit, alpha),
+		    _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+	}
+	/* SCAN_NOT_NUL */
+	return _mm256_andnot_si256(
+	    _mm256_cmpeq_epi8(v, _mm256_setzero_si256()),
+	    _mm256_set1_epi8(-1));
+}
+
+static AVX2 ALWAYS_INLINE size_t run_avx2(int set, const char *value,
+					  size_t length)
+{
+	if (!length || !has_byte(set, value[0]))
+		return 0;
+	size_t i = 0;
+	for (; i + 32 <= length; i += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i *)(value + i));
+		unsigned int outside =
+		    ~(unsigned int)_mm256_movemask_epi8(avx2_members(set, v));
+		if (outside)
+			return i + __builtin_ctz(outside);
+	}
+	/* the rest of the run is left to the narrower kernel */
+	return i + run_sse2(set, value + i, length - i);
+}
+
+static AVX2 size_t scan_run_avx2(int set, const char *value, size_t length)
+{
+	switch (set) {
+	case SCAN_BLANK:
+		return run_avx2(SCAN_BLANK, value, length);
+	case SCAN_DIGIT:
+		return run_avx2(SCAN_DIGIT, value, length);
+	case SCAN_ALNUM:
+		return run_avx2(SCAN_ALNUM, value, length);
+	case SCAN_WORD:
+		return run_avx2(SCAN_WORD, value, length);
+	case SCAN_NOT_NUL:
+		return run_avx2(SCAN_NOT_NUL, value, length);
+	}
+	return 0;
+}
+
+#endif /* HAS_X86_KERNELS */
+
+/* the kernel in use, the scalar one being always correct */
+static size_t (*run_kernel)(int set, const char *value,
+			    size_t length) = scan_run_scalar;
+
+size_t scan_run(int set, const char *value, size_t length)
+{
+	return run_kernel(set, value, length);
+}
+
+const char *select_scan_kernel(void)
+{
+#ifdef HAS_X86_KERNELS
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2")) {
+		run_kernel = scan_run_avx2;
+		return "avx2";
+	}
+	if (__builtin_cpu_supports("sse2")) {
+		run_kernel = scan_run_sse2;
+		return "sse2";
+	}
+#endif
+	run_kernel = scan_run_scalar;
+	return "scalar";
+}
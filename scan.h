@@ -0,0 +1,63 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <stddef.h>
+
+/*
+ * Kernels finding the end of a run of bytes of a given set, used to skip
+ * blanks in the lexer and to walk through the loops of the token DFA (the rest
+ * of an identifier, a constant or a comment) without going byte by byte.
+ *
+ * They classify 16 (SSE2) or 32 (AVX2) bytes at once, the widest one the CPU
+ * supports being selected at runtime by select_scan_kernel(), with a portable
+ * scalar fallback used until then and on other architectures.
+ */
+
+/* the sets of bytes a run can be made of */
+enum scan_set {
+	/* not a set, e.g. a DFA state not looping on any of them */
+	SCAN_NONE,
+	/* ' ', '\v', '\f' and '\r', i.e. the blanks which do not move the
+	 * column by more than one nor end the line */
+	SCAN_BLANK,
+	/* [0-9] */
+	SCAN_DIGIT,
+	/* [A-Za-z0-9] */
+	SCAN_ALNUM,
+	/* [A-Za-z0-9_], the word characters of `\b` */
+	SCAN_WORD,
+	/* anything but NUL, e.g. '.' */
+	SCAN_NOT_NUL,
+	SCAN_SET_COUNT
+};
+
+/**
+ * scan_run() - find the end of the run of bytes of a set at the beginning of
+ * the input.
+ * @set:	the &enum scan_set (not SCAN_NONE)
+ * @value:	the input
+ * @length:	the length of the input
+ *
+ * Return: 	the length of the run
+ */
+size_t scan_run(int set, const char *value, size_t length);
+
+/**
+ * scan_has() - check if a byte belongs to a set.
+ * @set:	the &enum scan_set
+ * @c:		the byte
+ *
+ * Return: 	0: @c is not in @set
+ * 		1: @c is in @set
+ */
+int scan_has(int set, unsigned char c);
+
+/**
+ * select_scan_kernel() - select the widest kernel the CPU supports, to be
+ * called before any thread is started.
+ *
+ * Return: 	the name of the kernel ("avx2", "sse2" or "scalar")
+ */
+const char *select_scan_kernel(void);
+
+#endif /* SCAN_H */
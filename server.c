@@ -0,0 +1,353 @@
+#include "server.h"
+#include "context.h"
+#include "parser.h"
+#include "setting.h"
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * struct connection (Connection) - a client connection and the requests
+ * received from it but not answered yet.
+ * @socket:	the connected socket
+ * @buffer:	the received content
+ * @start:	position of the next request in @buffer
+ * @end:	the end of the received content
+ * @capacity:	the allocated size of @buffer
+ */
+typedef struct connection {
+	int socket;
+	char *buffer;
+	size_t start;
+	size_t end;
+	size_t capacity;
+} Connection;
+
+/**
+ * struct server (Server) - the state shared by the workers.
+ * @socket:		the listening socket
+ * @options:		the &Parse_Options of every request
+ * @is_stopping:	boolean indicates if the server is shutting down
+ * @lock:		protect @is_stopping and the connections of the
+ * 			workers
+ */
+typedef struct server {
+	int socket;
+	Parse_Options *options;
+	int is_stopping;
+	pthread_mutex_t lock;
+} Server;
+
+/**
+ * struct server_worker (Server_Worker) - a worker thread and the memory it
+ * keeps from one request to the next.
+ * @server:	the &Server
+ * @thread:	the thread
+ * @connection:	the &Connection being served (its socket is -1 if none)
+ * @context:	the &Parse_Context every request is parsed with
+ * @name:	the name of the current input (NUL-terminated)
+ * @path:	the path of the current file (NUL-terminated)
+ * @name_capacity:	the allocated size of @name
+ * @path_capacity:	the allocated size of @path
+ */
+typedef struct server_worker {
+	Server *server;
+	pthread_t thread;
+	Connection connection;
+	Parse_Context context;
+	char *name;
+	char *path;
+	size_t name_capacity;
+	size_t path_capacity;
+} Server_Worker;
+
+/* make sure the connection holds the given number of bytes from its next
+ * request, return -1 if the client is gone or too slow */
+static int receive(Connection *connection, size_t length)
+{
+	if (connection->end - connection->start >= length)
+		return 0;
+	/* move the request to the front, then grow the buffer if needed */
+	if (connection->start) {
+		memmove(connection->buffer,
+			connection->buffer + connection->start,
+			connection->end - connection->start);
+		connection->end -= connection->start;
+		connection->start = 0;
+	}
+	if (connection->capacity < length) {
+		connection->capacity = length + OUTPUT_BUFFER_SIZE;
+		connection->buffer =
+		    (char *)realloc(connection->buffer, connection->capacity);
+	}
+	while (connection->end < length) {
+		ssize_t read_size = recv(connection->socket,
+					 connection->buffer + connection->end,
+					 connection->capacity - connection->end,
+					 0);
+		if (read_size <= 0)
+			return -1;
+		connection->end += read_size;
+	}
+	return 0;
+}
+
+/* give the memory of a large request back once it has been answered, keeping
+ * what was already received of the next ones */
+static void shrink(Connection *connection)
+{
+	size_t pending = connection->end - connection->start;
+	if (connection->capacity <= OUTPUT_BUFFER_SIZE ||
+	    pending > OUTPUT_BUFFER_SIZE)
+		return;
+	memmove(connection->buffer, connection->buffer + connection->start,
+		pending);
+	connection->start = 0;
+	connection->end = pending;
+	connection->capacity = OUTPUT_BUFFER_SIZE;
+	connection->buffer =
+	    (char *)realloc(connection->buffer, connection->capacity);
+}
+
+static int send_all(int socket, const char *data, size_t length)
+{
+	while (length) {
+		ssize_t write_size = send(socket, data, length, MSG_NOSIGNAL);
+		if (write_size <= 0)
+			return -1;
+		data += write_size;
+		length -= write_size;
+	}
+	return 0;
+}
+
+/* copy a string of the request into a NUL-terminated buffer of the worker */
+static char *copy_string(char **buffer, size_t *capacity, const char *value,
+			 size_t length)
+{
+	if (*capacity <= length) {
+		*capacity = length + 256;
+		*buffer = (char *)realloc(*buffer, *capacity);
+	}
+	memcpy(*buffer, value, length);
+	(*buffer)[length] = '\0';
+	return *buffer;
+}
+
+/* answer the next request of the connection, return -1 to close it */
+static int serve_request(Server_Worker *worker)
+{
+	Connection *connection = &worker->connection;
+	Parse_Context *context = &worker->context;
+	Parse_Options *options = worker->server->options;
+
+	/* read the header, which ends the first line of the request */
+	char *header_end = NULL;
+	size_t header_length;
+	for (header_length = 1; !header_end; ++header_length) {
+		if (header_length > MAX_HEADER_LENGTH ||
+		    receive(connection, header_length))
+			return -1;
+		char *header = connection->buffer + connection->start;
+		header_end = (char *)memchr(header, '\n', header_length);
+	}
+	char kind;
+	size_t name_length, length;
+	*header_end = '\0';
+	if (sscanf(connection->buffer + connection->start, "%c %zu %zu", &kind,
+		   &name_length, &length) != 3 ||
+	    (kind != REQUEST_FILE && kind != REQUEST_DATA) ||
+	    name_length > SERVER_MAX_REQUEST_SIZE ||
+	    length > SERVER_MAX_REQUEST_SIZE - name_length)
+		return -1;
+	header_length =
+	    header_end + 1 - (connection->buffer + connection->start);
+	if (receive(connection, header_length + name_length + length))
+		return -1;
+	const char *name =
+	    connection->buffer + connection->start + header_length;
+	const char *payload = name + name_length;
+	char *input_name = copy_string(&worker->name, &worker->name_capacity,
+				       name, name_length);
+
+	/* parse it like ./parse would do with a single file */
+	reset_context(context, options);
+	reset_output(&context->out);
+	print_report_header(&context->out, options->format);
+	int status;
+	if (kind == REQUEST_FILE) {
+		char *path = copy_string(&worker->path, &worker->path_capacity,
+					 payload, length);
+		status = -1;
+		if (!load_input(context, path)) {
+			/* the messages refer to the input by its name */
+			context->file_name = input_name;
+			status = parse_input(context);
+		}
+	} else {
+		load_buffer(context, input_name, payload, length);
+		status = parse_input(context);
+	}
+	print_report_footer(&context->out, options->format);
+	connection->start += header_length + name_length + length;
+	shrink(connection);
+
+	char header[MAX_HEADER_LENGTH];
+	int written = snprintf(header, sizeof(header), "%d %zu\n",
+			       status < 0 ? 2 : status, context->out.length);
+	if (send_all(connection->socket, header, written) ||
+	    send_all(connection->socket, context->out.buffer,
+		     context->out.length))
+		return -1;
+	return 0;
+}
+
+static void *run_server_worker(void *argument)
+{
+	Server_Worker *worker = (Server_Worker *)argument;
+	Server *server = worker->server;
+	Connection *connection = &worker->connection;
+	struct timeval timeout = {.tv_sec = SERVER_IDLE_TIMEOUT};
+	for (;;) {
+		int client = accept(server->socket, NULL, NULL);
+		pthread_mutex_lock(&server->lock);
+		if (server->is_stopping) {
+			pthread_mutex_unlock(&server->lock);
+			if (client >= 0)
+				close(client);
+			break;
+		}
+		connection->socket = client;
+		pthread_mutex_unlock(&server->lock);
+		if (client < 0)
+			continue;
+
+		setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+			   sizeof(timeout));
+		connection->start = 0;
+		connection->end = 0;
+		while (!serve_request(worker))
+			;
+
+		pthread_mutex_lock(&server->lock);
+		connection->socket = -1;
+		pthread_mutex_unlock(&server->lock);
+		close(client);
+	}
+	return NULL;
+}
+
+/* suffix of the path the socket is bound to before it listens */
+static const char binding_suffix[] = ".binding";
+
+/* remove a socket left by a previous server, failing on anything else */
+static int remove_socket(const char *path)
+{
+	struct stat file_stat;
+	if (lstat(path, &file_stat))
+		return 0;
+	if (!S_ISSOCK(file_stat.st_mode)) {
+		errno = EADDRINUSE;
+		return -1;
+	}
+	return unlink(path);
+}
+
+/* listen on the socket at its path, replacing the socket of a previous
+ * server: the socket is bound next to it then renamed, so that the path only
+ * appears once the connections are accepted */
+static int listen_socket(int server_socket, char *socket_path)
+{
+	struct sockaddr_un address;
+	if (strlen(socket_path) + sizeof(binding_suffix) >
+	    sizeof(address.sun_path)) {
+		errno = ENAMETOOLONG;
+		return -1;
+	}
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, socket_path);
+	strcat(address.sun_path, binding_suffix);
+	if (remove_socket(socket_path) || remove_socket(address.sun_path) ||
+	    bind(server_socket, (struct sockaddr *)&address,
+		 sizeof(address)))
+		return -1;
+	if (listen(server_socket, SOMAXCONN) ||
+	    rename(address.sun_path, socket_path)) {
+		int error = errno;
+		unlink(address.sun_path);
+		errno = error;
+		return -1;
+	}
+	return 0;
+}
+
+int run_server(char *socket_path, int job_count, Parse_Options *options)
+{
+	Server server;
+	server.options = options;
+	server.is_stopping = 0;
+	server.socket = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (server.socket < 0 || listen_socket(server.socket, socket_path)) {
+		printf("%sERROR - cannot listen on %s: %s%s\n", ERROR_COL,
+		       socket_path, strerror(errno), COL_RESET);
+		if (server.socket >= 0)
+			close(server.socket);
+		return 2;
+	}
+
+	/* the signals are only waited for by the main thread */
+	sigset_t signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+	pthread_mutex_init(&server.lock, NULL);
+	Server_Worker *workers =
+	    (Server_Worker *)calloc(job_count, sizeof(Server_Worker));
+	for (int i = 0; i < job_count; ++i) {
+		workers[i].server = &server;
+		workers[i].connection.socket = -1;
+		init_context(&workers[i].context, options, NULL);
+		pthread_create(&workers[i].thread, NULL, run_server_worker,
+			       workers + i);
+	}
+	printf("%sINFO - serving on %s with %d worker(s)%s\n", INFO_COL,
+	       socket_path, job_count, COL_RESET);
+	fflush(stdout);
+
+	int signal_number;
+	sigwait(&signals, &signal_number);
+
+	/* wake the workers up from accept() and from their clients */
+	pthread_mutex_lock(&server.lock);
+	server.is_stopping = 1;
+	shutdown(server.socket, SHUT_RDWR);
+	for (int i = 0; i < job_count; ++i)
+		if (workers[i].connection.socket >= 0)
+			shutdown(workers[i].connection.socket, SHUT_RDWR);
+	pthread_mutex_unlock(&server.lock);
+
+	/* cleanup */
+	for (int i = 0; i < job_count; ++i) {
+		pthread_join(workers[i].thread, NULL);
+		clean_context(&workers[i].context);
+		free(workers[i].connection.buffer);
+		free(workers[i].name);
+		free(workers[i].path);
+	}
+	free(workers);
+	close(server.socket);
+	unlink(socket_path);
+	pthread_mutex_destroy(&server.lock);
+	return 0;
+}
@@ -0,0 +1,43 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "context.h"
+
+/*
+ * Protocol of the daemon, over a stream Unix domain socket. A client sends
+ * any number of requests on a connection, each answered in order:
+ *
+ *	request:	<kind> <name_length> <length>\n<name><payload>
+ *	response:	<status> <length>\n<messages>
+ *
+ * where <kind> is 'F' for a file whose path is the <length> bytes of
+ * <payload>, or 'D' for an input whose content is <payload>. <name> is the
+ * name the messages refer to the input by. <status> is 0 if the input was
+ * parsed without error, 1 if it has error(s) and 2 if it could not be loaded,
+ * and <messages> are the messages `./parse <name>` prints (a file which
+ * cannot be loaded is referred to by its path). A malformed request closes
+ * the connection.
+ */
+
+/* kinds of request */
+#define REQUEST_FILE 'F'
+#define REQUEST_DATA 'D'
+
+/* the longest request or response header */
+#define MAX_HEADER_LENGTH 64
+
+/**
+ * run_server() - serve parse requests on a Unix domain socket until SIGINT or
+ * SIGTERM, with a pool of worker threads each handling a connection at a
+ * time and reusing the memory of its &Parse_Context from one request to the
+ * next.
+ * @socket_path:	path of the socket, replacing a stale one
+ * @job_count:		the number of worker threads
+ * @options:		the &Parse_Options of every request
+ *
+ * Return: 	0: stopped by a signal
+ * 		2: the socket could not be set up
+ */
+int run_server(char *socket_path, int job_count, Parse_Options *options);
+
+#endif /* SERVER_H */
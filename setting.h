@@ -9,10 +9,29 @@
 #define PARSE_DEBUG_ENABLED 1
 /* CODE_DISPLAY option controls source matching feature of the parser */
 #define CODE_DISPLAY_ENABLED 1
+/* MAX_ERRORS_CONTEXT_LINES option controls how many lines around each error
+ * the source code is shown with when --max-errors is given without --context */
+#define MAX_ERRORS_CONTEXT_LINES 2
 /* TAB_SIZE_WARNING option controls warning message about tab usage */
 #define TAB_SIZE_WARNING_ENABLED 1
 /* SUCCESS_DISPLAY option controls successful parsing (without error) message */
 #define SUCCESS_DISPLAY_ENABLED 1
+/* ARENA_BLOCK_SIZE option controls the minimum size of the blocks the arenas
+ * (e.g. the one holding the error list) allocate at once */
+#define ARENA_BLOCK_SIZE 65536
+/* DOCUMENT_COMPACT_RATIO option controls how many times the memory of a full
+ * parse of a document (see incremental.h) its edits can take before it is
+ * parsed from scratch to release the lines they replaced */
+#define DOCUMENT_COMPACT_RATIO 2
+/* SERVER_IDLE_TIMEOUT option controls how many second(s) the daemon waits for
+ * the next request of a client before dropping it */
+#define SERVER_IDLE_TIMEOUT 30
+/* SERVER_MAX_REQUEST_SIZE option controls the maximum size of a request sent
+ * to the daemon (name and content) */
+#define SERVER_MAX_REQUEST_SIZE (1 << 30)
+/* STATS option controls the runtime instrumentation behind --stats (off at
+ * runtime unless --stats is given) */
+#define STATS_ENABLED 1
 
 //================================================================================
 // LEXICAL ANALYZER
@@ -22,15 +41,16 @@
 #define LEX_DEBUG_ENABLED 1
 /* SYN_DEBUG option controls debugging message inside of the syntax analyzer */
 #define TAB_SIZE 8
-/* TOKEN_DEFINITION_FILE indicates the definition file for tokens and the POSIX
- * regex pattern used to match these tokens */
-#define TOKEN_DEFINITION_FILE "token_definition.txt"
-/* MAX_LINE_LENGTH option controls how many characters to be read at most for a
- * line in the lexical analyzer */
-#define MAX_LINE_LENGTH 1000
 /* MAX_MESSAGE_LENGTH option controls how many characters to be used at most for
 * a lexeme */
 #define MAX_LEXEME_LENGTH 100
+/* SIMD_SCAN_ENABLED option controls the use of SSE2/AVX2 kernels (if the CPU
+ * has them) to skip blanks and the rest of identifiers, constants and
+ * comments, 0 leaving only the scalar code */
+#define SIMD_SCAN_ENABLED 1
+/* TOKEN_QUEUE_SIZE option controls how many tokens the lexer thread can be
+ * ahead of the syntax analyzer in the pipelined mode (a power of 2) */
+#define TOKEN_QUEUE_SIZE 4096
 
 //================================================================================
 // SYNTAX ANALYZER
@@ -47,11 +67,21 @@
 /* MAX_MESSAGE_LENGTH option controls how many characters to be used at most for
 * a message everywhere */
 #define MAX_MESSAGE_LENGTH 100
+/* TRACE_BUFFER_SIZE option controls how many events of --trace are buffered
+ * before being written out at once */
+#define TRACE_BUFFER_SIZE 65536
 
 //================================================================================
 // DISPLAY
 //================================================================================
 
+/* OUTPUT_BUFFER_SIZE option controls the minimum growth of the buffer messages
+ * are collected into before being written out */
+#define OUTPUT_BUFFER_SIZE 65536
+/* OUTPUT_FLUSH_SIZE option controls how large the buffered messages can get
+ * before being written out (when they are not kept for later) */
+#define OUTPUT_FLUSH_SIZE (1 << 20)
+
 /* MONOCHROME option controls color display of the output in the terminal */
 #ifdef MONOCHROME
 #define COL_RESET ""
@@ -0,0 +1,127 @@
+#include "stats.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if STATS_ENABLED == 1
+int stats_enabled = STATS_OFF;
+#endif
+_Thread_local Stats thread_stats;
+
+/* the counts of the threads done so far */
+static Stats total_stats;
+static pthread_mutex_t total_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static const char *timer_names[] = {"token_definitions", "lex", "parse",
+				    "code_display", "cleanup"};
+static const char *counter_names[] = {
+    "lookups",	   "keyword_hits",  "dfa_runs", "regexec_calls",
+    "blank_bytes", "lexeme_bytes", "errors",   "malloc_calls"};
+
+_Static_assert(sizeof(timer_names) / sizeof(*timer_names) ==
+		   STATS_TIMER_COUNT,
+	       "a timer has no name");
+_Static_assert(sizeof(counter_names) / sizeof(*counter_names) ==
+		   STATS_COUNTER_COUNT,
+	       "a counter has no name");
+
+uint64_t stats_now(void)
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (uint64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+void stats_flush(void)
+{
+	if (!stats_enabled)
+		return;
+	pthread_mutex_lock(&total_lock);
+	for (int i = 0; i < STATS_TIMER_COUNT; ++i)
+		total_stats.timers[i] += thread_stats.timers[i];
+	for (int i = 0; i < STATS_COUNTER_COUNT; ++i)
+		total_stats.counters[i] += thread_stats.counters[i];
+	for (int i = 0; i <= STATS_NO_TOKEN; ++i)
+		total_stats.lookups[i] += thread_stats.lookups[i];
+	pthread_mutex_unlock(&total_lock);
+	memset(&thread_stats, 0, sizeof(Stats));
+}
+
+/* name of the token kind lookups end with */
+static const char *get_kind_name(int kind)
+{
+	if (kind < TOKEN_KIND_COUNT)
+		return token_kind_names[kind];
+	return kind == TOKEN_KIND_COUNT ? "(other)" : "(none)";
+}
+
+void print_stats(FILE *file)
+{
+	if (!stats_enabled)
+		return;
+	stats_flush();
+	Stats *stats = &total_stats;
+	if (stats_enabled == STATS_JSON) {
+		fprintf(file, "{\"time_ms\":{");
+		for (int i = 0; i < STATS_TIMER_COUNT; ++i)
+			fprintf(file, "%s\"%s\":%.3f", i ? "," : "",
+				timer_names[i], stats->timers[i] / 1e6);
+		fprintf(file, "},\"counters\":{");
+		for (int i = 0; i < STATS_COUNTER_COUNT; ++i)
+			fprintf(file, "%s\"%s\":%llu", i ? "," : "",
+				counter_names[i],
+				(unsigned long long)stats->counters[i]);
+		fprintf(file, "},\"lookups\":{");
+		for (int i = 0, count = 0; i <= STATS_NO_TOKEN; ++i) {
+			if (stats->lookups[i])
+				fprintf(file, "%s\"%s\":%llu", count++ ? "," : "",
+					get_kind_name(i),
+					(unsigned long long)stats->lookups[i]);
+		}
+		fprintf(file, "}}\n");
+		return;
+	}
+	fprintf(file, "%sSTATS - time (ms):", INFO_COL);
+	for (int i = 0; i < STATS_TIMER_COUNT; ++i)
+		fprintf(file, " %s %.3f", timer_names[i],
+			stats->timers[i] / 1e6);
+	fprintf(file, "%s\n%sSTATS - counters:", COL_RESET, INFO_COL);
+	for (int i = 0; i < STATS_COUNTER_COUNT; ++i)
+		fprintf(file, " %s %llu", counter_names[i],
+			(unsigned long long)stats->counters[i]);
+	fprintf(file, "%s\n%sSTATS - lookups:", COL_RESET, INFO_COL);
+	for (int i = 0; i <= STATS_NO_TOKEN; ++i) {
+		if (stats->lookups[i])
+			fprintf(file, " %s %llu", get_kind_name(i),
+				(unsigned long long)stats->lookups[i]);
+	}
+	fprintf(file, "%s\n", COL_RESET);
+}
+
+#if STATS_ENABLED == 1 && !defined(DISABLE_MALLOC_WRAP)
+/* the allocations of the parser, counted when it is linked with
+ * -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc (see Makefile, only if
+ * STATS_ENABLED is 1), which the programs using the library are not */
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+	stats_add(STATS_MALLOC_CALLS, 1);
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+	stats_add(STATS_MALLOC_CALLS, 1);
+	return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size)
+{
+	stats_add(STATS_MALLOC_CALLS, 1);
+	return __real_realloc(pointer, size);
+}
+#endif
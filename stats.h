@@ -0,0 +1,128 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "setting.h"
+#include "token_table.h"
+#include <stdint.h>
+#include <stdio.h>
+
+/*
+ * Runtime instrumentation (--stats): timers of the phases of the parser and
+ * counters of its hot paths, reported at exit. Each thread counts on its own
+ * and adds its counts to the totals with stats_flush(), so that the hot paths
+ * never share a cache line. With --stats off, the instrumentation is a
+ * predictable branch (nothing at all if STATS_ENABLED is 0 in setting.h).
+ */
+
+/* the phases timed */
+enum stats_timer {
+	/* loading the token definitions */
+	STATS_TOKEN_DEFINITIONS,
+	/* lex() */
+	STATS_LEX,
+	/* the syntax analysis, lex() excluded */
+	STATS_PARSE,
+	/* code_display() */
+	STATS_CODE_DISPLAY,
+	/* cleanup() */
+	STATS_CLEANUP,
+	STATS_TIMER_COUNT
+};
+
+/* the events counted */
+enum stats_counter {
+	/* calls of lookup() */
+	STATS_LOOKUPS,
+	/* tokens found by the keyword table */
+	STATS_KEYWORD_HITS,
+	/* runs of the token DFA */
+	STATS_DFA_RUNS,
+	/* calls of regexec() */
+	STATS_REGEXEC_CALLS,
+	/* bytes skipped by ltrim() */
+	STATS_BLANK_BYTES,
+	/* bytes of the lexemes lex() steps over (comments, unknown characters
+	 * and lexemes too long included) */
+	STATS_LEXEME_BYTES,
+	/* errors added with add_error() */
+	STATS_ERRORS,
+	/* calls of malloc(), calloc() and realloc() */
+	STATS_MALLOC_CALLS,
+	STATS_COUNTER_COUNT
+};
+
+/* the kind lookup() ends with when no token matches */
+#define STATS_NO_TOKEN (TOKEN_KIND_COUNT + 1)
+
+/**
+ * struct stats (Stats) - the counts of a thread, or the totals.
+ * @timers:	the time spent in each phase (see &enum stats_timer), in
+ * 		nanoseconds
+ * @counters:	the number of each event (see &enum stats_counter)
+ * @lookups:	for each token kind, the number of lookups ending with it
+ * 		(STATS_NO_TOKEN if none)
+ */
+typedef struct stats {
+	uint64_t timers[STATS_TIMER_COUNT];
+	uint64_t counters[STATS_COUNTER_COUNT];
+	uint64_t lookups[STATS_NO_TOKEN + 1];
+} Stats;
+
+/* how the report is printed */
+enum stats_format { STATS_OFF, STATS_TEXT, STATS_JSON };
+
+#if STATS_ENABLED == 1
+/* the &enum stats_format of --stats, STATS_OFF by default */
+extern int stats_enabled;
+#else
+#define stats_enabled 0
+#endif
+
+/* the counts of the current thread */
+extern _Thread_local Stats thread_stats;
+
+/* the monotonic time in nanoseconds */
+uint64_t stats_now(void);
+
+/* start a timer (0 if --stats is off) */
+static inline uint64_t stats_start(void)
+{
+	return stats_enabled ? stats_now() : 0;
+}
+
+/* stop a timer started at @start */
+static inline void stats_stop(int timer, uint64_t start)
+{
+	if (stats_enabled)
+		thread_stats.timers[timer] += stats_now() - start;
+}
+
+/* count @count events */
+static inline void stats_add(int counter, uint64_t count)
+{
+	if (stats_enabled)
+		thread_stats.counters[counter] += count;
+}
+
+/* count a lookup ending with a token of the given kind */
+static inline void stats_add_lookup(int kind)
+{
+	if (stats_enabled) {
+		++thread_stats.counters[STATS_LOOKUPS];
+		++thread_stats.lookups[kind];
+	}
+}
+
+/**
+ * stats_flush() - add the counts of the current thread to the totals, e.g.
+ * when it is done with an input.
+ */
+void stats_flush(void);
+
+/**
+ * print_stats() - print the totals, in the format of --stats.
+ * @file:	the file the report goes to
+ */
+void print_stats(FILE *file);
+
+#endif /* STATS_H */
@@ -0,0 +1,109 @@
+#include "symbol.h"
+#include "setting.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* the number of slots of a table's first hash table */
+#define SYMBOL_TABLE_MIN_SLOTS 256
+
+/* FNV-1a, the names being short */
+static uint32_t hash_name(const char *name, size_t length)
+{
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < length; ++i) {
+		hash ^= (unsigned char)name[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/* double the slots, putting the symbols back by their hashes */
+static void grow_slots(Symbol_Table *table)
+{
+	free(table->slots);
+	table->slot_count = table->slot_count ? table->slot_count * 2
+					      : SYMBOL_TABLE_MIN_SLOTS;
+	table->slots =
+	    (uint32_t *)calloc(table->slot_count, sizeof(uint32_t));
+	uint32_t mask = table->slot_count - 1;
+	for (uint32_t id = 0; id < table->count; ++id) {
+		uint32_t slot = table->symbols[id].hash & mask;
+		while (table->slots[slot])
+			slot = (slot + 1) & mask;
+		table->slots[slot] = id + 1;
+	}
+}
+
+void init_symbol_table(Symbol_Table *table)
+{
+	table->symbols = NULL;
+	table->count = 0;
+	table->capacity = 0;
+	table->slots = NULL;
+	table->slot_count = 0;
+	init_arena(&table->names);
+}
+
+uint32_t intern_symbol(Symbol_Table *table, const char *name, size_t length,
+		       int line, int column)
+{
+	/* at most half of the slots are used, so that the probes stay short */
+	if (table->count * 2 >= table->slot_count)
+		grow_slots(table);
+	uint32_t hash = hash_name(name, length);
+	uint32_t mask = table->slot_count - 1;
+	uint32_t slot = hash & mask;
+	while (table->slots[slot]) {
+		Symbol *symbol = table->symbols + table->slots[slot] - 1;
+		if (symbol->hash == hash && symbol->length == length &&
+		    !memcmp(symbol->name, name, length)) {
+			++symbol->use_count;
+			return table->slots[slot] - 1;
+		}
+		slot = (slot + 1) & mask;
+	}
+
+	if (table->count == table->capacity) {
+		table->capacity = table->capacity * 2 + 64;
+		table->symbols = (Symbol *)realloc(
+		    table->symbols, table->capacity * sizeof(Symbol));
+	}
+	uint32_t id = table->count++;
+	Symbol *symbol = table->symbols + id;
+	symbol->name = arena_strndup(&table->names, name, length);
+	symbol->length = length;
+	symbol->hash = hash;
+	symbol->use_count = 1;
+	symbol->line = line;
+	symbol->column = column;
+	table->slots[slot] = id + 1;
+	return id;
+}
+
+void print_symbol_table(Symbol_Table *table, Output *out)
+{
+	output_printf(out, "%sINFO - %u symbol(s)%s\n", INFO_COL, table->count,
+		      COL_RESET);
+	for (uint32_t id = 0; id < table->count; ++id) {
+		Symbol *symbol = table->symbols + id;
+		output_printf(out, "%u %s [%d:%d] %u use(s)\n", id,
+			      symbol->name, symbol->line, symbol->column + 1,
+			      symbol->use_count);
+	}
+}
+
+void reset_symbol_table(Symbol_Table *table)
+{
+	if (table->slots)
+		memset(table->slots, 0, table->slot_count * sizeof(uint32_t));
+	table->count = 0;
+	reset_arena(&table->names);
+}
+
+void clean_symbol_table(Symbol_Table *table)
+{
+	free(table->symbols);
+	free(table->slots);
+	clean_arena(&table->names);
+	init_symbol_table(table);
+}
@@ -0,0 +1,101 @@
+#ifndef SYMBOL_H
+#define SYMBOL_H
+
+#include "arena.h"
+#include "output.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * The identifiers of the input are interned as they reach the syntax analyzer
+ * (--symbols): every distinct name gets a symbol, a dense 32-bit index into
+ * the table, found through an open-addressing hash table over the bytes of
+ * the name. The names are copied once into an arena, so the memory of the
+ * table grows with the number of distinct names, not with the number of times
+ * they occur, and the later passes compare names by their symbols.
+ */
+
+/* the symbol of a token which is not an identifier */
+#define NO_SYMBOL UINT32_MAX
+
+/**
+ * struct symbol (Symbol) - a distinct identifier of the input.
+ * @name:	the name (NUL-terminated, in the arena of the table)
+ * @length:	the length of the name
+ * @hash:	the hash of the name
+ * @use_count:	the number of times the name occurs
+ * @line:	the line where the name first occurs (the language has no
+ * 		declaration, a name is defined where it is first seen)
+ * @column:	the column where the name first occurs
+ */
+typedef struct symbol {
+	const char *name;
+	uint32_t length;
+	uint32_t hash;
+	uint32_t use_count;
+	int line;
+	int column;
+} Symbol;
+
+/**
+ * struct symbol_table (Symbol_Table) - the symbols of an input.
+ * @symbols:		the symbols, in the order the names first occur
+ * @count:		the number of @symbols
+ * @capacity:		the allocated number of @symbols
+ * @slots:		the hash table, each slot holding a symbol + 1 (0 for an
+ * 			empty slot), probed linearly
+ * @slot_count:		the number of @slots (a power of 2, at least twice
+ * 			@count)
+ * @names:		holds the names
+ */
+typedef struct symbol_table {
+	Symbol *symbols;
+	uint32_t count;
+	uint32_t capacity;
+	uint32_t *slots;
+	uint32_t slot_count;
+	Arena names;
+} Symbol_Table;
+
+/**
+ * init_symbol_table() - initialize an empty table.
+ * @table:	the &Symbol_Table
+ */
+void init_symbol_table(Symbol_Table *table);
+
+/**
+ * intern_symbol() - get the symbol of a name, adding it to the table the
+ * first time, and count the occurrence.
+ * @table:	the &Symbol_Table
+ * @name:	the name (not NUL-terminated)
+ * @length:	the length of the name
+ * @line:	the line where the name occurs
+ * @column:	the column where the name occurs
+ *
+ * Return: 	the symbol
+ */
+uint32_t intern_symbol(Symbol_Table *table, const char *name, size_t length,
+		       int line, int column);
+
+/**
+ * print_symbol_table() - print the symbols, one per line, with where they
+ * first occur and how many times.
+ * @table:	the &Symbol_Table
+ * @out:	the &Output
+ */
+void print_symbol_table(Symbol_Table *table, Output *out);
+
+/**
+ * reset_symbol_table() - empty the table, keeping its memory for the next
+ * input.
+ * @table:	the &Symbol_Table
+ */
+void reset_symbol_table(Symbol_Table *table);
+
+/**
+ * clean_symbol_table() - free the table.
+ * @table:	the &Symbol_Table
+ */
+void clean_symbol_table(Symbol_Table *table);
+
+#endif /* SYMBOL_H */
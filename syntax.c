@@ -1,408 +1,509 @@
 #include "syntax.h"
-#include "parse_error.h"
+#include "context.h"
+#include "incremental.h"
 #include "setting.h"
+#include "trace.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-extern Parse_Error *error_list;
-extern int error_junk_after_program_end;
-extern int error_unexpected_eof;
-extern int line_number;
-extern int col_number;
-
-Lex_Token *lex_token;
-
-char *options_variable[] = {"PROGNAME_VARIABLE", "VARIABLE"};
-char *options_simpl_stmt[] = {"PROGNAME_VARIABLE", "VARIABLE", "READ", "WRITE"};
-char *options_struct_stmt[] = {"BEGIN", "IF", "WHILE"};
-
-void indent_depth(int change)
+void indent_depth(Parse_Context *context, int change)
 {
-	static int depth;
 	char format[MAX_PARSE_DISPLAY_DEPTH * PARSE_DISPLAY_TAB_LENGTH];
 
 	if (change < 0) {
-		depth += change;
-		if (depth < 0)
-			depth = 0;
+		context->display_depth += change;
+		if (context->display_depth < 0)
+			context->display_depth = 0;
 	}
 
-	if (depth > 0) {
-		int temp = depth * PARSE_DISPLAY_TAB_LENGTH;
+	if (context->display_depth > 0) {
+		int temp = context->display_depth * PARSE_DISPLAY_TAB_LENGTH;
 		sprintf(format, "%%%d.%ds", temp, temp);
 		printf(format, "");
 	}
 
 	if (change > 0)
-		depth += change;
+		context->display_depth += change;
 }
 
-void enter_non_terminal(char *non_terminal_name)
+/* the position of the current token (from 1, as in the messages), or of the
+ * end of the input, <program> being entered before the first token is read
+ * at the start of the input */
+static void get_position(Parse_Context *context, int *line, int *column)
+{
+	Lexer *lexer = &context->lexer;
+	if (!context->lex_token && !context->token_index) {
+		*line = 1;
+		*column = 1;
+		return;
+	}
+	*line = lexer->line_number;
+	*column = lexer->col_number + 1;
+	if (context->lex_token)
+		*column -= context->lex_token->length;
+}
+
+void enter_non_terminal(Parse_Context *context, int non_terminal)
 {
 #if defined(DEBUG) && defined(SYN_DEBUG_ENABLED)
-	indent_depth(1);
-	printf("%s%s (enter)%s\n", NORMAL_COL, non_terminal_name, COL_RESET);
+	indent_depth(context, 1);
+	printf("%s%s (enter)%s\n", NORMAL_COL,
+	       non_terminal_names[non_terminal], COL_RESET);
 #endif
+	if (context->trace)
+		add_trace_event(context->trace, TRACE_ENTER, non_terminal,
+				context->token_index);
+	if (context->options.ast_mode) {
+		/* the non-terminal starts at the current token */
+		size_t offset = context->lex_token ? context->lex_token->offset
+						   : context->lexer.cursor;
+		ast_enter(&context->ast, non_terminal, offset);
+	}
+	if (context->events && context->events->enter) {
+		int line, column;
+		get_position(context, &line, &column);
+		context->events->enter(context->events->user_data,
+				       non_terminal, line, column);
+	}
 }
 
-void exit_non_terminal(char *non_terminal_name)
+void exit_non_terminal(Parse_Context *context, int non_terminal)
 {
 #if defined(DEBUG) && defined(SYN_DEBUG_ENABLED)
-	indent_depth(-1);
-	printf("%s%s (exit)%s\n", NORMAL_COL, non_terminal_name, COL_RESET);
+	indent_depth(context, -1);
+	printf("%s%s (exit)%s\n", NORMAL_COL,
+	       non_terminal_names[non_terminal], COL_RESET);
 #endif
+	if (context->trace)
+		add_trace_event(context->trace, TRACE_EXIT, non_terminal,
+				context->token_index);
+	if (context->options.ast_mode)
+		ast_exit(&context->ast);
+	if (context->events && context->events->exit) {
+		int line, column;
+		get_position(context, &line, &column);
+		context->events->exit(context->events->user_data, non_terminal,
+				      line, column);
+	}
+}
+
+void consume_token(Parse_Context *context)
+{
+	Lex_Token *lex_token = context->lex_token;
+	if (context->options.ast_mode && lex_token)
+		ast_add_terminal(&context->ast, lex_token->token->kind,
+				 lex_token->offset, lex_token->length);
+	if (context->events && context->events->terminal && lex_token) {
+		int line, column;
+		get_position(context, &line, &column);
+		context->events->terminal(
+		    context->events->user_data, lex_token->token->kind,
+		    get_lexeme(&context->lexer, lex_token), lex_token->length,
+		    line, column);
+	}
+	context->lex_token = lex(context);
+	++context->token_index;
+	/* a token accepted ends the recovery */
+	context->is_recovering = 0;
 }
 
-int are_equal(Lex_Token *lex_token, char *token_name)
+/* skip the tokens up to one of @sync (which has end), the begin ... end
+ * blocks on the way being skipped whole */
+static void skip_tokens(Parse_Context *context, Token_Set sync)
+{
+	int depth = 0;
+	while (context->lex_token &&
+	       (depth || !are_equal_any(context->lex_token, sync))) {
+		if (are_equal(context->lex_token, TOKEN_BEGIN))
+			++depth;
+		else if (are_equal(context->lex_token, TOKEN_END))
+			--depth;
+		context->lex_token = lex(context);
+		++context->token_index;
+	}
+}
+
+int can_resume_statements(Parse_Context *context)
+{
+	if (!context->is_recovering)
+		return 0;
+	/* then, do and else cannot follow a statement of the block either */
+	skip_tokens(context,
+		    TOKEN_BIT(TOKEN_SEMICOLON) | TOKEN_BIT(TOKEN_END));
+	return context->lex_token != NULL;
+}
+
+int are_equal(Lex_Token *lex_token, int kind)
 {
 	if (!lex_token)
 		return 0;
-	if (!strcmp(lex_token->token->name, token_name))
-		return 1;
-	return 0;
+	return lex_token->token->kind == kind;
 }
 
-int are_equal_any(Lex_Token *lex_token, char *token_names[], int size)
+int are_equal_any(Lex_Token *lex_token, Token_Set kinds)
 {
 	if (!lex_token)
 		return 0;
-	for (int i = 0; i < size; ++i) {
-		if (!strcmp(lex_token->token->name, token_names[i]))
-			return 1;
-	}
-	return 0;
+	return (TOKEN_BIT(lex_token->token->kind) & kinds) != 0;
 }
 
-void check_token(char *token_name, char *expected_token)
+void check_token(Parse_Context *context, int kind, char *expected_token)
 {
 	/* only get next token if the current token matched */
-	if (are_equal(lex_token, token_name)) {
-		lex_token = lex();
+	if (are_equal(context->lex_token, kind)) {
+		consume_token(context);
 	} else {
-		if (!lex_token) {
+		if (!context->lex_token) {
 			return;
 		} else {
-			add_syntax_error(expected_token);
+			add_syntax_error(context, TOKEN_BIT(kind),
+					 expected_token);
 		}
 	}
 }
 
-void check_token_any(char *token_names[], int size, char *expected_token)
+void check_token_any(Parse_Context *context, Token_Set kinds,
+		     char *expected_token)
 {
-	if (are_equal_any(lex_token, token_names, size)) {
-		lex_token = lex();
+	if (are_equal_any(context->lex_token, kinds)) {
+		consume_token(context);
 	} else {
-		if (!lex_token) {
+		if (!context->lex_token) {
 			return;
 		} else {
-			add_syntax_error(expected_token);
+			add_syntax_error(context, kinds, expected_token);
 		}
 	}
 }
 
-void add_syntax_error(char *expected_token)
+void add_syntax_error(Parse_Context *context, Token_Set expected,
+		      char *expected_token)
 {
-	char error_msg[MAX_MESSAGE_LENGTH];
-	sprintf(error_msg, "ERROR - expect %s but saw '%s'", expected_token,
-		lex_token->lexeme);
-	add_error(error_msg, line_number,
-		  col_number - strlen(lex_token->lexeme), col_number);
+	/* the errors following from the one being recovered from are not
+	 * reported */
+	if (context->is_recovering)
+		return;
+	Lexer *lexer = &context->lexer;
+	Lex_Token *lex_token = context->lex_token;
+	/* the lexeme is only copied (into the message) here */
+	char error_msg[MAX_MESSAGE_LENGTH + MAX_LEXEME_LENGTH];
+	snprintf(error_msg, sizeof(error_msg), "expect %s but saw '%.*s'",
+		 expected_token, lex_token->length,
+		 get_lexeme(lexer, lex_token));
+	add_error(context, ERROR_UNEXPECTED_TOKEN, expected, error_msg,
+		  lexer->line_number, lexer->col_number - lex_token->length,
+		  lexer->col_number);
+	if (context->options.recovery == RECOVERY_PANIC) {
+		context->is_recovering = 1;
+		skip_tokens(context, OPTIONS_SYNC);
+	}
 }
 
-void program()
+void program(Parse_Context *context)
 {
-	enter_non_terminal("<program>");
+	enter_non_terminal(context, NT_PROGRAM);
 
 	/* <program> ::= program <progname> <compound stmt> */
-	lex_token = lex();
+	context->lex_token = lex(context);
 	EXIT_IF_NULL();
-	check_token("PROGRAM", "'program'");
+	check_token(context, TOKEN_PROGRAM, "'program'");
 	EXIT_IF_NULL();
-	check_token("PROGNAME_VARIABLE", "<progname>");
+	check_token(context, TOKEN_PROGNAME_VARIABLE, "<progname>");
 	EXIT_IF_NULL();
-	compound_statement();
+	compound_statement(context);
 
 	/* check if there is junk after the end of program */
-	if (!error_unexpected_eof) {
-		if (lex_token) {
-			error_junk_after_program_end = 1;
-			add_error("ERROR - detect non-empty content after end "
-				  "of program",
-				  line_number,
-				  col_number - strlen(lex_token->lexeme),
-				  MAX_LINE_LENGTH + 1);
+	if (!context->error_unexpected_eof) {
+		if (context->lex_token) {
+			context->error_junk_after_program_end = 1;
+			add_error(context, ERROR_JUNK_AFTER_PROGRAM_END, 0,
+				  "detect non-empty content after end of "
+				  "program",
+				  context->lexer.line_number,
+				  context->lexer.col_number -
+				      context->lex_token->length,
+				  END_OF_LINE_COL);
 			return;
 		}
 	} else {
 		return;
 	}
 
-	exit_non_terminal("<program>");
+	exit_non_terminal(context, NT_PROGRAM);
 }
 
-void compound_statement()
+void compound_statement(Parse_Context *context)
 {
-	enter_non_terminal("<compound_statement>");
+	enter_non_terminal(context, NT_COMPOUND_STATEMENT);
+	/* a document may have parsed it already */
+	if (context->document && reuse_block(context)) {
+		exit_non_terminal(context, NT_COMPOUND_STATEMENT);
+		return;
+	}
 
 	/* <compound stmt> ::= begin <stmt> {; <stmt>} end */
-	check_token("BEGIN", "'begin'");
+	check_token(context, TOKEN_BEGIN, "'begin'");
 	EXIT_IF_NULL();
-	statement();
+	statement(context);
 	EXIT_IF_NULL();
-	while (are_equal(lex_token, "SEMICOLON")) {
-		lex_token = lex();
+	do {
+		while (are_equal(context->lex_token, TOKEN_SEMICOLON)) {
+			consume_token(context);
+			EXIT_IF_NULL();
+			statement(context);
+		}
 		EXIT_IF_NULL();
-		statement();
-	}
-	EXIT_IF_NULL();
-	check_token("END", "end");
+		check_token(context, TOKEN_END, "end");
+	} while (can_resume_statements(context));
 
-	exit_non_terminal("<compound_statement>");
+	if (context->document)
+		end_block(context);
+	exit_non_terminal(context, NT_COMPOUND_STATEMENT);
 }
 
-void statement()
+void statement(Parse_Context *context)
 {
-	enter_non_terminal("<statement>");
+	enter_non_terminal(context, NT_STATEMENT);
 
 	/* <stmt> ::= <simple stmt> | <structured stmt> */
-	if (are_equal_any(lex_token, options_simpl_stmt,
-			  ARRAY_SIZE(options_simpl_stmt))) {
-		simple_statement();
-	} else if (are_equal_any(lex_token, options_struct_stmt,
-				 ARRAY_SIZE(options_struct_stmt))) {
-		structured_statement();
+	if (are_equal_any(context->lex_token, OPTIONS_SIMPL_STMT)) {
+		simple_statement(context);
+	} else if (are_equal_any(context->lex_token, OPTIONS_STRUCT_STMT)) {
+		structured_statement(context);
 	} else {
-		add_syntax_error("<variable>, \'read\', \'write\', "
-				 "\'begin\', \'if\', or \'while\'");
+		add_syntax_error(context,
+				 OPTIONS_SIMPL_STMT | OPTIONS_STRUCT_STMT,
+				 "<variable>, \'read\', \'write\', \'begin\', "
+				 "\'if\', or \'while\'");
 	}
 	EXIT_IF_NULL();
 
-	exit_non_terminal("<statement>");
+	exit_non_terminal(context, NT_STATEMENT);
 }
 
-void simple_statement()
+void simple_statement(Parse_Context *context)
 {
-	enter_non_terminal("<simple_statement>");
+	enter_non_terminal(context, NT_SIMPLE_STATEMENT);
 
 	/* <simple stmt> ::= <assignment stmt> | <read stmt> | <write stmt> |
 			  <comment> */
-	if (are_equal_any(lex_token, options_variable,
-			  ARRAY_SIZE(options_variable))) {
-		assignment_statement();
-	} else if (are_equal(lex_token, "READ")) {
-		read_statement();
-	} else if (are_equal(lex_token, "WRITE")) {
-		write_statement();
+	if (are_equal_any(context->lex_token, OPTIONS_VARIABLE)) {
+		assignment_statement(context);
+	} else if (are_equal(context->lex_token, TOKEN_READ)) {
+		read_statement(context);
+	} else if (are_equal(context->lex_token, TOKEN_WRITE)) {
+		write_statement(context);
 	} else {
-		add_syntax_error("<variable>, \'read\', or \'write\'");
+		add_syntax_error(context, OPTIONS_SIMPL_STMT,
+				 "<variable>, \'read\', or \'write\'");
 	}
 	EXIT_IF_NULL();
 
-	exit_non_terminal("<simple_statement>");
+	exit_non_terminal(context, NT_SIMPLE_STATEMENT);
 }
 
-void assignment_statement()
+void assignment_statement(Parse_Context *context)
 {
-	enter_non_terminal("<assignment_statement>");
+	enter_non_terminal(context, NT_ASSIGNMENT_STATEMENT);
 
 	/* <assignment stmt> ::= <variable> := <expression> */
 
-	check_token_any(options_variable, ARRAY_SIZE(options_variable),
-			"<variable>");
+	check_token_any(context, OPTIONS_VARIABLE, "<variable>");
 	EXIT_IF_NULL();
-	check_token("ASSIGNING_OPERATOR", "':='");
+	check_token(context, TOKEN_ASSIGNING_OPERATOR, "':='");
 	EXIT_IF_NULL();
-	expression();
+	expression(context);
 	EXIT_IF_NULL();
 
-	exit_non_terminal("<assignment_statement>");
+	exit_non_terminal(context, NT_ASSIGNMENT_STATEMENT);
 }
 
-void read_statement()
+void read_statement(Parse_Context *context)
 {
-	enter_non_terminal("<read_statement>");
+	enter_non_terminal(context, NT_READ_STATEMENT);
 
 	/* <read stmt> ::= read ( <variable> { , <variable> } ) */
-	check_token("READ", "':='");
+	check_token(context, TOKEN_READ, "':='");
 	EXIT_IF_NULL();
-	check_token("LEFT_PARENTHESIS", "'('");
+	check_token(context, TOKEN_LEFT_PARENTHESIS, "'('");
 	EXIT_IF_NULL();
-	check_token_any(options_variable, ARRAY_SIZE(options_variable),
-			"<variable>");
+	check_token_any(context, OPTIONS_VARIABLE, "<variable>");
 	EXIT_IF_NULL();
-	while (are_equal(lex_token, "COMMA")) {
-		lex_token = lex();
+	while (are_equal(context->lex_token, TOKEN_COMMA)) {
+		consume_token(context);
 		EXIT_IF_NULL();
-		check_token_any(options_variable, ARRAY_SIZE(options_variable),
-				"<variable>");
+		check_token_any(context, OPTIONS_VARIABLE, "<variable>");
 	}
 	EXIT_IF_NULL();
-	check_token("RIGHT_PARENTHESIS", "')'");
+	check_token(context, TOKEN_RIGHT_PARENTHESIS, "')'");
 	EXIT_IF_NULL();
 
-	exit_non_terminal("<read_statement>");
+	exit_non_terminal(context, NT_READ_STATEMENT);
 }
 
-void write_statement()
+void write_statement(Parse_Context *context)
 {
-	enter_non_terminal("<write_statement>");
+	enter_non_terminal(context, NT_WRITE_STATEMENT);
 
 	/* <write stmt> ::= write ( <expression> { , <expression> } ) */
-	check_token("WRITE", "'write");
+	check_token(context, TOKEN_WRITE, "'write");
 	EXIT_IF_NULL();
-	check_token("LEFT_PARENTHESIS", "'('");
+	check_token(context, TOKEN_LEFT_PARENTHESIS, "'('");
 	EXIT_IF_NULL();
-	expression();
+	expression(context);
 	EXIT_IF_NULL();
-	while (are_equal(lex_token, "COMMA")) {
-		lex_token = lex();
+	while (are_equal(context->lex_token, TOKEN_COMMA)) {
+		consume_token(context);
 		EXIT_IF_NULL();
-		expression();
+		expression(context);
 	}
 	EXIT_IF_NULL();
-	check_token("RIGHT_PARENTHESIS", "')'");
+	check_token(context, TOKEN_RIGHT_PARENTHESIS, "')'");
 	EXIT_IF_NULL();
 
-	exit_non_terminal("<write_statement>");
+	exit_non_terminal(context, NT_WRITE_STATEMENT);
 }
 
-void structured_statement()
+void structured_statement(Parse_Context *context)
 {
-	enter_non_terminal("<structured_statement>");
+	enter_non_terminal(context, NT_STRUCTURED_STATEMENT);
 
 	/* <structured stmt> ::= <compound stmt> | <if stmt> | <while stmt> */
-	if (are_equal(lex_token, "BEGIN")) {
-		compound_statement();
-	} else if (are_equal(lex_token, "IF")) {
-		if_statement();
-	} else if (are_equal(lex_token, "WHILE")) {
-		while_statement();
+	if (are_equal(context->lex_token, TOKEN_BEGIN)) {
+		compound_statement(context);
+	} else if (are_equal(context->lex_token, TOKEN_IF)) {
+		if_statement(context);
+	} else if (are_equal(context->lex_token, TOKEN_WHILE)) {
+		while_statement(context);
 	} else {
-		add_syntax_error("\'begin\', \'if\', or \'while\'");
+		add_syntax_error(context, OPTIONS_STRUCT_STMT,
+				 "\'begin\', \'if\', or \'while\'");
 	}
 	EXIT_IF_NULL();
 
-	exit_non_terminal("<structured_statement>");
+	exit_non_terminal(context, NT_STRUCTURED_STATEMENT);
 }
 
-void if_statement()
+void if_statement(Parse_Context *context)
 {
-	enter_non_terminal("<if_statement>");
+	enter_non_terminal(context, NT_IF_STATEMENT);
 
 	/* <if stmt> ::= if <expression> then <stmt> |
 			 if <expression> then <stmt> else <stmt> */
-	check_token("IF", "'if'");
+	check_token(context, TOKEN_IF, "'if'");
 	EXIT_IF_NULL();
-	expression();
+	expression(context);
 	EXIT_IF_NULL();
-	check_token("THEN", "'then'");
+	check_token(context, TOKEN_THEN, "'then'");
 	EXIT_IF_NULL();
-	statement();
+	statement(context);
 	EXIT_IF_NULL();
-	if (are_equal(lex_token, "ELSE")) {
-		lex_token = lex();
+	if (are_equal(context->lex_token, TOKEN_ELSE)) {
+		consume_token(context);
 		EXIT_IF_NULL();
-		statement();
+		statement(context);
 	}
 	EXIT_IF_NULL();
 
-	exit_non_terminal("<if_statement>");
+	exit_non_terminal(context, NT_IF_STATEMENT);
 }
 
-void while_statement()
+void while_statement(Parse_Context *context)
 {
-	enter_non_terminal("<while_statement>");
+	enter_non_terminal(context, NT_WHILE_STATEMENT);
 
 	/* <while stmt> ::= while <expression> do <stmt> */
-	check_token("WHILE", "'while'");
+	check_token(context, TOKEN_WHILE, "'while'");
 	EXIT_IF_NULL();
-	expression();
+	expression(context);
 	EXIT_IF_NULL();
-	check_token("DO", "'do'");
+	check_token(context, TOKEN_DO, "'do'");
 	EXIT_IF_NULL();
-	statement();
+	statement(context);
 	EXIT_IF_NULL();
 
-	exit_non_terminal("<while_statement>");
+	exit_non_terminal(context, NT_WHILE_STATEMENT);
 }
 
-void expression()
+void expression(Parse_Context *context)
 {
-	enter_non_terminal("<expression>");
+	enter_non_terminal(context, NT_EXPRESSION);
 
 	/* <expression> ::= <simple expr> |
 			    <simple expr> <relational_operator> <simple expr> */
-	simple_expression();
+	simple_expression(context);
 	EXIT_IF_NULL();
-	if (are_equal(lex_token, "RELATIONAL_OPERATOR")) {
-		lex_token = lex();
+	if (are_equal(context->lex_token, TOKEN_RELATIONAL_OPERATOR)) {
+		consume_token(context);
 		EXIT_IF_NULL();
-		simple_expression();
+		simple_expression(context);
 	}
 	EXIT_IF_NULL();
 
-	exit_non_terminal("<expression>");
+	exit_non_terminal(context, NT_EXPRESSION);
 }
 
-void simple_expression()
+void simple_expression(Parse_Context *context)
 {
-	enter_non_terminal("<simple_expression>");
+	enter_non_terminal(context, NT_SIMPLE_EXPRESSION);
 
 	/* <simple expr> ::= [ <sign> ] <term> { <adding_operator> <term> } */
-	if (are_equal(lex_token, "ADDING_OPERATOR")) {
-		lex_token = lex();
+	if (are_equal(context->lex_token, TOKEN_ADDING_OPERATOR)) {
+		consume_token(context);
 		EXIT_IF_NULL();
 	}
-	term();
+	term(context);
 	EXIT_IF_NULL();
-	while (are_equal(lex_token, "ADDING_OPERATOR")) {
-		lex_token = lex();
+	while (are_equal(context->lex_token, TOKEN_ADDING_OPERATOR)) {
+		consume_token(context);
 		EXIT_IF_NULL();
-		term();
+		term(context);
 	}
 	EXIT_IF_NULL();
 
-	exit_non_terminal("<simple_expression>");
+	exit_non_terminal(context, NT_SIMPLE_EXPRESSION);
 }
 
-void term()
+void term(Parse_Context *context)
 {
-	enter_non_terminal("<term>");
+	enter_non_terminal(context, NT_TERM);
 
 	/* <term> ::= <factor> { <multiplying_operator> <factor> } */
-	factor();
+	factor(context);
 	EXIT_IF_NULL();
-	while (are_equal(lex_token, "MULTIPLYING_OPERATOR")) {
-		lex_token = lex();
+	while (are_equal(context->lex_token, TOKEN_MULTIPLYING_OPERATOR)) {
+		consume_token(context);
 		EXIT_IF_NULL();
-		factor();
+		factor(context);
 	}
 	EXIT_IF_NULL();
 
-	exit_non_terminal("<term>");
+	exit_non_terminal(context, NT_TERM);
 }
 
-void factor()
+void factor(Parse_Context *context)
 {
-	enter_non_terminal("<factor>");
+	enter_non_terminal(context, NT_FACTOR);
 
 	/* <factor> ::= <variable> | <constant> | ( <expression> ) */
-	if (are_equal_any(lex_token, options_variable,
-			  ARRAY_SIZE(options_variable))) {
-		lex_token = lex();
-	} else if (are_equal(lex_token, "CONSTANT")) {
-		lex_token = lex();
-	} else if (are_equal(lex_token, "LEFT_PARENTHESIS")) {
-		lex_token = lex();
+	if (are_equal_any(context->lex_token, OPTIONS_VARIABLE)) {
+		consume_token(context);
+	} else if (are_equal(context->lex_token, TOKEN_CONSTANT)) {
+		consume_token(context);
+	} else if (are_equal(context->lex_token, TOKEN_LEFT_PARENTHESIS)) {
+		consume_token(context);
 		EXIT_IF_NULL();
-		expression();
+		expression(context);
 		EXIT_IF_NULL();
-		check_token("RIGHT_PARENTHESIS", "')'");
+		check_token(context, TOKEN_RIGHT_PARENTHESIS, "')'");
 	} else {
-		add_syntax_error("<variable>, <constant>, or ( <expression> )");
+		add_syntax_error(context,
+				 OPTIONS_VARIABLE | TOKEN_BIT(TOKEN_CONSTANT) |
+				     TOKEN_BIT(TOKEN_LEFT_PARENTHESIS),
+				 "<variable>, <constant>, or ( <expression> )");
 	}
 	EXIT_IF_NULL();
 
-	exit_non_terminal("<factor>");
+	exit_non_terminal(context, NT_FACTOR);
 }
\ No newline at end of file
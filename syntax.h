@@ -1,91 +1,123 @@
 #ifndef SYNTAX_H
 #define SYNTAX_H
 
-#include "lexical.h"
+#include "context.h"
+#include "token_table.h"
 
-#define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
+_Static_assert(TOKEN_KIND_COUNT < 64, "token kinds do not fit in Token_Set");
 
 /* the check for EOF token must be written in macro so that the return command
  * can exit the current non-terminal function */
 #define EXIT_IF_NULL()                                                         \
-	if (!lex_token) {                                                      \
-		if (!error_unexpected_eof) {                                   \
-			add_error("ERROR - detect unexpected EOF",             \
-				  line_number, col_number,                     \
-				  MAX_LINE_LENGTH + 1);                        \
-			error_unexpected_eof = 1;                              \
+	if (!context->lex_token) {                                             \
+		if (!context->error_unexpected_eof &&                          \
+		    !context->has_given_up) {                                  \
+			add_error(context, ERROR_UNEXPECTED_EOF, 0,            \
+				  "detect unexpected EOF",                     \
+				  context->lexer.line_number,                  \
+				  context->lexer.col_number, END_OF_LINE_COL); \
+			context->error_unexpected_eof = 1;                     \
 		}                                                              \
 		return;                                                        \
 	}
 
-/* the current token being checked */
-extern Lex_Token *lex_token;
 /* group of options to check for non-terminal or terminal */
-extern char *options_variable[];
-extern char *options_simpl_stmt[];
-extern char *options_struct_stmt[];
+#define OPTIONS_VARIABLE                                                       \
+	(TOKEN_BIT(TOKEN_PROGNAME_VARIABLE) | TOKEN_BIT(TOKEN_VARIABLE))
+#define OPTIONS_SIMPL_STMT                                                     \
+	(OPTIONS_VARIABLE | TOKEN_BIT(TOKEN_READ) | TOKEN_BIT(TOKEN_WRITE))
+#define OPTIONS_STRUCT_STMT                                                    \
+	(TOKEN_BIT(TOKEN_BEGIN) | TOKEN_BIT(TOKEN_IF) | TOKEN_BIT(TOKEN_WHILE))
+/* the tokens the panic-mode recovery skips to: FOLLOW(<stmt>) and what
+ * follows the condition of an if or a while statement */
+#define OPTIONS_SYNC                                                           \
+	(TOKEN_BIT(TOKEN_SEMICOLON) | TOKEN_BIT(TOKEN_END) |                   \
+	 TOKEN_BIT(TOKEN_ELSE) | TOKEN_BIT(TOKEN_THEN) | TOKEN_BIT(TOKEN_DO))
 
 /**
- * add_syntax_error() - create a &Parse_Error error and print it.
+ * add_syntax_error() - create a &Parse_Error error and print it, then skip to
+ * a token of OPTIONS_SYNC with RECOVERY_PANIC (the errors are not reported
+ * until a token is accepted).
+ * @context: 		the &Parse_Context
+ * @expected: 		the kinds of the expected tokens
  * @expected_token: 	the token(s) to be expected
  */
-void add_syntax_error(char *expected_token);
+void add_syntax_error(Parse_Context *context, Token_Set expected,
+		      char *expected_token);
+
+/**
+ * can_resume_statements() - after the panic-mode recovery from a missing end,
+ * skip to the next ';' or end, from which the statements of the <compound
+ * stmt> go on.
+ * @context: 		the &Parse_Context
+ *
+ * Return: 	0: the <compound stmt> is over
+ * 		1: the statements go on
+ */
+int can_resume_statements(Parse_Context *context);
 
 /**
  * are_equal() - check if the specified token match the expected token.
  * @lex_token: 		the current token
- * @token_name: 	the name of the expected token
+ * @kind: 		the kind of the expected token
  *
  * Return: 	0: unmatched
  * 		1: matched
  */
-int are_equal(Lex_Token *lex_token, char *token_name);
+int are_equal(Lex_Token *lex_token, int kind);
 
 /**
  * are_equal_any() - check if the specified token match the expected tokens.
  * @lex_token: 		the current token
- * @token_names: 	the list of names of the expected tokens
- * @size: 		the size of the list of names of the expected tokens
+ * @kinds: 		the set of kinds of the expected tokens
  *
  * Return: 	0: unmatched
  * 		1: matched
  */
-int are_equal_any(Lex_Token *lex_token, char *token_names[], int size);
+int are_equal_any(Lex_Token *lex_token, Token_Set kinds);
 
 /**
  * check_token() - get the next token if the specified token match the expected token, otherwise, add a syntax error and keep the current token for the next syntax analyzer step.
- * @token_name: 	the name of the expected token
+ * @context: 		the &Parse_Context
+ * @kind: 		the kind of the expected token
  * @expected_token: 	the token(s) to be expected
  */
-void check_token(char *token_name, char *expected_token);
+void check_token(Parse_Context *context, int kind, char *expected_token);
 
 /**
  * check_token_any() - get next token if the specified token match the expected tokens, otherwise, add a syntax error and keep the current token for the next syntax analyzer step.
- * @token_names: 	the list of names of the expected tokens
- * @size: 		the size of the list of names of the expected tokens
+ * @context: 		the &Parse_Context
+ * @kinds: 		the set of kinds of the expected tokens
  * @expected_token: 	the token(s) to be expected
  */
-void check_token_any(char *token_names[], int size, char *expected_token);
+void check_token_any(Parse_Context *context, Token_Set kinds,
+		     char *expected_token);
+
+/**
+ * consume_token() - accept the current token and get the next one.
+ * @context: 		the &Parse_Context
+ */
+void consume_token(Parse_Context *context);
 
-/* group of debugging message display functions */
-void indent_depth(int depth);
-void enter_non_terminal(char *non_terminal_name);
-void exit_non_terminal(char *non_terminal_name);
+/* group of debugging message display, tracing and AST building functions */
+void indent_depth(Parse_Context *context, int depth);
+void enter_non_terminal(Parse_Context *context, int non_terminal);
+void exit_non_terminal(Parse_Context *context, int non_terminal);
 
 /* group of non-terminal syntax analyzer functions */
-void program(void);
-void compound_statement(void);
-void statement(void);
-void simple_statement(void);
-void assignment_statement(void);
-void read_statement(void);
-void write_statement(void);
-void structured_statement(void);
-void if_statement(void);
-void while_statement(void);
-void expression(void);
-void simple_expression(void);
-void term(void);
-void factor(void);
+void program(Parse_Context *context);
+void compound_statement(Parse_Context *context);
+void statement(Parse_Context *context);
+void simple_statement(Parse_Context *context);
+void assignment_statement(Parse_Context *context);
+void read_statement(Parse_Context *context);
+void write_statement(Parse_Context *context);
+void structured_statement(Parse_Context *context);
+void if_statement(Parse_Context *context);
+void while_statement(Parse_Context *context);
+void expression(Parse_Context *context);
+void simple_expression(Parse_Context *context);
+void term(Parse_Context *context);
+void factor(Parse_Context *context);
 
 #endif /* SYNTAX_H */
\ No newline at end of file
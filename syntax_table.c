@@ -0,0 +1,388 @@
+#include "syntax_table.h"
+#include "context.h"
+#include "incremental.h"
+#include "setting.h"
+#include "syntax.h"
+#include <pthread.h>
+#include <stdlib.h>
+
+/* the longest production */
+#define MAX_PRODUCTION_LENGTH 12
+
+/* shorthands for the symbols of the productions */
+#define T(check) SYMBOL(SYMBOL_TERMINAL, check)
+#define N(non_terminal) SYMBOL(SYMBOL_NON_TERMINAL, non_terminal)
+#define E(non_terminal) SYMBOL(SYMBOL_ERROR, non_terminal)
+#define A(action) SYMBOL(SYMBOL_ACTION, action)
+#define X A(ACTION_EXIT_IF_NULL)
+
+/**
+ * struct check (Check) - a token to check, as check_token_any() does.
+ * @kinds:	the kinds of token accepted
+ * @expected:	what is expected (in the error message)
+ */
+typedef struct check {
+	Token_Set kinds;
+	const char *expected;
+} Check;
+
+/* the tokens checked, with the messages of the recursive analyzer */
+enum check_id {
+	CHECK_PROGRAM,
+	CHECK_PROGNAME,
+	CHECK_BEGIN,
+	CHECK_END,
+	CHECK_SEMICOLON,
+	CHECK_VARIABLE,
+	CHECK_ASSIGNING_OPERATOR,
+	CHECK_READ,
+	CHECK_WRITE,
+	CHECK_LEFT_PARENTHESIS,
+	CHECK_RIGHT_PARENTHESIS,
+	CHECK_COMMA,
+	CHECK_IF,
+	CHECK_THEN,
+	CHECK_ELSE,
+	CHECK_WHILE,
+	CHECK_DO,
+	CHECK_CONSTANT,
+	CHECK_RELATIONAL_OPERATOR,
+	CHECK_ADDING_OPERATOR,
+	CHECK_MULTIPLYING_OPERATOR
+};
+
+static const Check checks[] = {
+    [CHECK_PROGRAM] = {TOKEN_BIT(TOKEN_PROGRAM), "'program'"},
+    [CHECK_PROGNAME] = {TOKEN_BIT(TOKEN_PROGNAME_VARIABLE), "<progname>"},
+    [CHECK_BEGIN] = {TOKEN_BIT(TOKEN_BEGIN), "'begin'"},
+    [CHECK_END] = {TOKEN_BIT(TOKEN_END), "end"},
+    [CHECK_SEMICOLON] = {TOKEN_BIT(TOKEN_SEMICOLON), "';'"},
+    [CHECK_VARIABLE] = {OPTIONS_VARIABLE, "<variable>"},
+    [CHECK_ASSIGNING_OPERATOR] = {TOKEN_BIT(TOKEN_ASSIGNING_OPERATOR),
+				  "':='"},
+    [CHECK_READ] = {TOKEN_BIT(TOKEN_READ), "':='"},
+    [CHECK_WRITE] = {TOKEN_BIT(TOKEN_WRITE), "'write"},
+    [CHECK_LEFT_PARENTHESIS] = {TOKEN_BIT(TOKEN_LEFT_PARENTHESIS), "'('"},
+    [CHECK_RIGHT_PARENTHESIS] = {TOKEN_BIT(TOKEN_RIGHT_PARENTHESIS), "')'"},
+    [CHECK_COMMA] = {TOKEN_BIT(TOKEN_COMMA), "','"},
+    [CHECK_IF] = {TOKEN_BIT(TOKEN_IF), "'if'"},
+    [CHECK_THEN] = {TOKEN_BIT(TOKEN_THEN), "'then'"},
+    [CHECK_ELSE] = {TOKEN_BIT(TOKEN_ELSE), "'else'"},
+    [CHECK_WHILE] = {TOKEN_BIT(TOKEN_WHILE), "'while'"},
+    [CHECK_DO] = {TOKEN_BIT(TOKEN_DO), "'do'"},
+    [CHECK_CONSTANT] = {TOKEN_BIT(TOKEN_CONSTANT), "<constant>"},
+    [CHECK_RELATIONAL_OPERATOR] = {TOKEN_BIT(TOKEN_RELATIONAL_OPERATOR),
+				   "<relational_operator>"},
+    [CHECK_ADDING_OPERATOR] = {TOKEN_BIT(TOKEN_ADDING_OPERATOR),
+			       "<adding_operator>"},
+    [CHECK_MULTIPLYING_OPERATOR] = {TOKEN_BIT(TOKEN_MULTIPLYING_OPERATOR),
+				    "<multiplying_operator>"}};
+
+/* the errors of the non-terminals with alternatives */
+static const Check errors[NON_TERMINAL_COUNT] = {
+    [NT_STATEMENT] = {OPTIONS_SIMPL_STMT | OPTIONS_STRUCT_STMT,
+		      "<variable>, 'read', 'write', 'begin', 'if', or 'while'"},
+    [NT_SIMPLE_STATEMENT] = {OPTIONS_SIMPL_STMT,
+			     "<variable>, 'read', or 'write'"},
+    [NT_STRUCTURED_STATEMENT] = {OPTIONS_STRUCT_STMT,
+				 "'begin', 'if', or 'while'"},
+    [NT_FACTOR] = {OPTIONS_VARIABLE | TOKEN_BIT(TOKEN_CONSTANT) |
+		       TOKEN_BIT(TOKEN_LEFT_PARENTHESIS),
+		   "<variable>, <constant>, or ( <expression> )"}};
+
+/**
+ * struct production (Production) - a production of the grammar.
+ * @non_terminal:	the non-terminal it expands
+ * @symbols:		its symbols, ending with SYMBOL_NONE
+ */
+typedef struct production {
+	int non_terminal;
+	uint16_t symbols[MAX_PRODUCTION_LENGTH + 1];
+} Production;
+
+/*
+ * The productions, X being EXIT_IF_NULL() where the recursive analyzer checks
+ * for EOF. The last production of a non-terminal is its default one, used for
+ * any lookahead out of the FIRST sets of the others: the only production, the
+ * empty one of a repetition or an option, or the error of the alternatives.
+ */
+static const Production productions[] = {
+    /* <program> ::= program <progname> <compound stmt> */
+    {NT_PROGRAM,
+     {A(ACTION_LEX), X, T(CHECK_PROGRAM), X, T(CHECK_PROGNAME), X,
+      N(NT_COMPOUND_STATEMENT), A(ACTION_CHECK_JUNK)}},
+    /* <compound stmt> ::= begin <stmt> {; <stmt>} end */
+    {NT_COMPOUND_STATEMENT,
+     {T(CHECK_BEGIN), X, N(NT_STATEMENT), X, N(NT_STATEMENT_TAIL), X,
+      T(CHECK_END), A(ACTION_RESUME_STATEMENTS), A(ACTION_END_BLOCK)}},
+    {NT_STATEMENT_TAIL,
+     {T(CHECK_SEMICOLON), X, N(NT_STATEMENT), N(NT_STATEMENT_TAIL)}},
+    {NT_STATEMENT_TAIL, {0}},
+    /* <stmt> ::= <simple stmt> | <structured stmt> */
+    {NT_STATEMENT, {N(NT_SIMPLE_STATEMENT), X}},
+    {NT_STATEMENT, {N(NT_STRUCTURED_STATEMENT), X}},
+    {NT_STATEMENT, {E(NT_STATEMENT), X}},
+    /* <simple stmt> ::= <assignment stmt> | <read stmt> | <write stmt> */
+    {NT_SIMPLE_STATEMENT, {N(NT_ASSIGNMENT_STATEMENT), X}},
+    {NT_SIMPLE_STATEMENT, {N(NT_READ_STATEMENT), X}},
+    {NT_SIMPLE_STATEMENT, {N(NT_WRITE_STATEMENT), X}},
+    {NT_SIMPLE_STATEMENT, {E(NT_SIMPLE_STATEMENT), X}},
+    /* <assignment stmt> ::= <variable> := <expression> */
+    {NT_ASSIGNMENT_STATEMENT,
+     {T(CHECK_VARIABLE), X, T(CHECK_ASSIGNING_OPERATOR), X,
+      N(NT_EXPRESSION), X}},
+    /* <read stmt> ::= read ( <variable> { , <variable> } ) */
+    {NT_READ_STATEMENT,
+     {T(CHECK_READ), X, T(CHECK_LEFT_PARENTHESIS), X, T(CHECK_VARIABLE), X,
+      N(NT_READ_TAIL), X, T(CHECK_RIGHT_PARENTHESIS), X}},
+    {NT_READ_TAIL, {T(CHECK_COMMA), X, T(CHECK_VARIABLE), N(NT_READ_TAIL)}},
+    {NT_READ_TAIL, {0}},
+    /* <write stmt> ::= write ( <expression> { , <expression> } ) */
+    {NT_WRITE_STATEMENT,
+     {T(CHECK_WRITE), X, T(CHECK_LEFT_PARENTHESIS), X, N(NT_EXPRESSION), X,
+      N(NT_WRITE_TAIL), X, T(CHECK_RIGHT_PARENTHESIS), X}},
+    {NT_WRITE_TAIL, {T(CHECK_COMMA), X, N(NT_EXPRESSION), N(NT_WRITE_TAIL)}},
+    {NT_WRITE_TAIL, {0}},
+    /* <structured stmt> ::= <compound stmt> | <if stmt> | <while stmt> */
+    {NT_STRUCTURED_STATEMENT, {N(NT_COMPOUND_STATEMENT), X}},
+    {NT_STRUCTURED_STATEMENT, {N(NT_IF_STATEMENT), X}},
+    {NT_STRUCTURED_STATEMENT, {N(NT_WHILE_STATEMENT), X}},
+    {NT_STRUCTURED_STATEMENT, {E(NT_STRUCTURED_STATEMENT), X}},
+    /* <if stmt> ::= if <expression> then <stmt> [ else <stmt> ] */
+    {NT_IF_STATEMENT,
+     {T(CHECK_IF), X, N(NT_EXPRESSION), X, T(CHECK_THEN), X, N(NT_STATEMENT),
+      X, N(NT_ELSE_PART), X}},
+    {NT_ELSE_PART, {T(CHECK_ELSE), X, N(NT_STATEMENT)}},
+    {NT_ELSE_PART, {0}},
+    /* <while stmt> ::= while <expression> do <stmt> */
+    {NT_WHILE_STATEMENT,
+     {T(CHECK_WHILE), X, N(NT_EXPRESSION), X, T(CHECK_DO), X, N(NT_STATEMENT),
+      X}},
+    /* <expression> ::= <simple expr> [ <relational_operator> <simple expr> ] */
+    {NT_EXPRESSION,
+     {N(NT_SIMPLE_EXPRESSION), X, N(NT_RELATION_PART), X}},
+    {NT_RELATION_PART,
+     {T(CHECK_RELATIONAL_OPERATOR), X, N(NT_SIMPLE_EXPRESSION)}},
+    {NT_RELATION_PART, {0}},
+    /* <simple expr> ::= [ <sign> ] <term> { <adding_operator> <term> } */
+    {NT_SIMPLE_EXPRESSION,
+     {N(NT_SIGN), N(NT_TERM), X, N(NT_ADDING_TAIL), X}},
+    {NT_SIGN, {T(CHECK_ADDING_OPERATOR), X}},
+    {NT_SIGN, {0}},
+    {NT_ADDING_TAIL,
+     {T(CHECK_ADDING_OPERATOR), X, N(NT_TERM), N(NT_ADDING_TAIL)}},
+    {NT_ADDING_TAIL, {0}},
+    /* <term> ::= <factor> { <multiplying_operator> <factor> } */
+    {NT_TERM, {N(NT_FACTOR), X, N(NT_MULTIPLYING_TAIL), X}},
+    {NT_MULTIPLYING_TAIL,
+     {T(CHECK_MULTIPLYING_OPERATOR), X, N(NT_FACTOR),
+      N(NT_MULTIPLYING_TAIL)}},
+    {NT_MULTIPLYING_TAIL, {0}},
+    /* <factor> ::= <variable> | <constant> | ( <expression> ) */
+    {NT_FACTOR, {T(CHECK_VARIABLE), X}},
+    {NT_FACTOR, {T(CHECK_CONSTANT), X}},
+    {NT_FACTOR,
+     {T(CHECK_LEFT_PARENTHESIS), X, N(NT_EXPRESSION), X,
+      T(CHECK_RIGHT_PARENTHESIS), X}},
+    {NT_FACTOR, {E(NT_FACTOR), X}}};
+
+#define PRODUCTION_COUNT (int)(sizeof(productions) / sizeof(Production))
+
+/* the LL(1) table, the production of a non-terminal for each lookahead */
+static uint8_t parse_table[TABLE_NON_TERMINAL_COUNT][TABLE_COLUMN_COUNT];
+/* the productions as pushed on the stack, i.e. reversed and with each
+ * EXIT_IF_NULL() turned into the SYMBOL_EXIT_IF_NULL flag of the symbol
+ * following it (the end of the non-terminal for the last one) */
+static uint16_t stack_symbols[PRODUCTION_COUNT][MAX_PRODUCTION_LENGTH + 1];
+static uint8_t stack_lengths[PRODUCTION_COUNT];
+static uint16_t exit_flags[PRODUCTION_COUNT];
+static pthread_once_t parse_table_once = PTHREAD_ONCE_INIT;
+
+/* the FIRST set of a production is the one of its first symbol, since no
+ * production starting with a non-terminal is chosen by lookahead unless the
+ * non-terminal cannot be empty */
+static Token_Set first_set(const Production *production,
+			   const Token_Set *first_sets)
+{
+	for (const uint16_t *symbol = production->symbols; *symbol; ++symbol) {
+		switch (SYMBOL_KIND(*symbol)) {
+		case SYMBOL_TERMINAL:
+			return checks[SYMBOL_VALUE(*symbol)].kinds;
+		case SYMBOL_NON_TERMINAL:
+			return first_sets[SYMBOL_VALUE(*symbol)];
+		case SYMBOL_ERROR:
+			return 0;
+		}
+	}
+	return 0;
+}
+
+static int is_default(int production)
+{
+	return production + 1 == PRODUCTION_COUNT ||
+	       productions[production + 1].non_terminal !=
+		   productions[production].non_terminal;
+}
+
+static void compile_production(int index)
+{
+	const Production *production = productions + index;
+	uint16_t symbols[MAX_PRODUCTION_LENGTH + 1];
+	uint16_t flag = 0;
+	int length = 0;
+	for (const uint16_t *symbol = production->symbols; *symbol; ++symbol) {
+		/* EXIT_IF_NULL() twice in a row only checks once */
+		if (*symbol == A(ACTION_EXIT_IF_NULL)) {
+			flag = SYMBOL_EXIT_IF_NULL;
+			continue;
+		}
+		symbols[length++] = *symbol | flag;
+		flag = 0;
+	}
+	/* the non-terminals out of the AST have no end to flag */
+	if (flag && production->non_terminal >= NON_TERMINAL_COUNT)
+		symbols[length++] = A(ACTION_EXIT_IF_NULL);
+	else
+		exit_flags[index] = flag;
+	stack_lengths[index] = length;
+	for (int i = 0; i < length; ++i)
+		stack_symbols[index][i] = symbols[length - 1 - i];
+}
+
+static void build_parse_table(void)
+{
+	/* the FIRST sets of the non-terminals, up to a fixed point */
+	Token_Set first_sets[TABLE_NON_TERMINAL_COUNT] = {0};
+	int has_changed = 1;
+	while (has_changed) {
+		has_changed = 0;
+		for (int i = 0; i < PRODUCTION_COUNT; ++i) {
+			Token_Set *set = first_sets + productions[i].non_terminal;
+			Token_Set first = first_set(productions + i, first_sets);
+			if ((*set | first) == *set)
+				continue;
+			*set |= first;
+			has_changed = 1;
+		}
+	}
+
+	/* the default production goes everywhere the others do not */
+	for (int i = PRODUCTION_COUNT - 1; i >= 0; --i) {
+		uint8_t *row = parse_table[productions[i].non_terminal];
+		compile_production(i);
+		if (is_default(i)) {
+			for (int column = 0; column < TABLE_COLUMN_COUNT;
+			     ++column)
+				row[column] = i;
+			continue;
+		}
+		Token_Set first = first_set(productions + i, first_sets);
+		for (int kind = 0; kind < TOKEN_KIND_COUNT; ++kind)
+			if (first & TOKEN_BIT(kind))
+				row[kind] = i;
+	}
+}
+
+/* make room for a production and the end of its non-terminal */
+static uint16_t *reserve_stack(Parse_Context *context, size_t depth)
+{
+	if (depth + MAX_PRODUCTION_LENGTH + 1 > context->parse_stack_capacity) {
+		context->parse_stack_capacity =
+		    context->parse_stack_capacity * 2 + 1024;
+		context->parse_stack = (uint16_t *)realloc(
+		    context->parse_stack,
+		    context->parse_stack_capacity * sizeof(uint16_t));
+	}
+	return context->parse_stack;
+}
+
+void table_parse(Parse_Context *context)
+{
+	pthread_once(&parse_table_once, build_parse_table);
+
+	uint16_t *stack = reserve_stack(context, 0);
+	size_t depth = 0;
+	stack[depth++] = N(NT_PROGRAM);
+	while (depth) {
+		uint16_t symbol = stack[--depth];
+		int value = SYMBOL_VALUE(symbol);
+		/* the recursive analyzer returns from every non-terminal from
+		 * there */
+		if (symbol & SYMBOL_EXIT_IF_NULL)
+			EXIT_IF_NULL();
+		switch (SYMBOL_KIND(symbol)) {
+		case SYMBOL_TERMINAL:
+			check_token_any(context, checks[value].kinds,
+					(char *)checks[value].expected);
+			break;
+		case SYMBOL_NON_TERMINAL: {
+			int column = context->lex_token
+					 ? context->lex_token->token->kind
+					 : TABLE_EOF_COLUMN;
+			int production = parse_table[value][column];
+			stack = reserve_stack(context, depth);
+			if (value < NON_TERMINAL_COUNT) {
+				enter_non_terminal(context, value);
+				/* a document may have parsed it already */
+				if (value == NT_COMPOUND_STATEMENT &&
+				    context->document && reuse_block(context)) {
+					exit_non_terminal(context, value);
+					break;
+				}
+				stack[depth++] = SYMBOL(SYMBOL_EXIT, value) |
+						 exit_flags[production];
+			}
+			for (int i = 0; i < stack_lengths[production]; ++i)
+				stack[depth++] = stack_symbols[production][i];
+			break;
+		}
+		case SYMBOL_EXIT:
+			exit_non_terminal(context, value);
+			break;
+		case SYMBOL_ERROR:
+			add_syntax_error(context, errors[value].kinds,
+					 (char *)errors[value].expected);
+			break;
+		case SYMBOL_ACTION:
+			switch (value) {
+			case ACTION_EXIT_IF_NULL:
+				EXIT_IF_NULL();
+				break;
+			case ACTION_LEX:
+				context->lex_token = lex(context);
+				break;
+			case ACTION_CHECK_JUNK:
+				if (context->lex_token) {
+					context->error_junk_after_program_end =
+					    1;
+					add_error(
+					    context,
+					    ERROR_JUNK_AFTER_PROGRAM_END, 0,
+					    "detect non-empty content after "
+					    "end of program",
+					    context->lexer.line_number,
+					    context->lexer.col_number -
+						context->lex_token->length,
+					    END_OF_LINE_COL);
+					return;
+				}
+				break;
+			case ACTION_END_BLOCK:
+				if (context->document)
+					end_block(context);
+				break;
+			case ACTION_RESUME_STATEMENTS:
+				/* the loop of the recursive analyzer */
+				if (!can_resume_statements(context))
+					break;
+				stack = reserve_stack(context, depth);
+				stack[depth++] = A(ACTION_RESUME_STATEMENTS);
+				stack[depth++] =
+				    T(CHECK_END) | SYMBOL_EXIT_IF_NULL;
+				stack[depth++] = N(NT_STATEMENT_TAIL);
+				break;
+			}
+			break;
+		}
+	}
+}
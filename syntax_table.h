@@ -0,0 +1,84 @@
+#ifndef SYNTAX_TABLE_H
+#define SYNTAX_TABLE_H
+
+#include "context.h"
+#include "token_table.h"
+#include <stdint.h>
+
+/*
+ * The table-driven syntax analyzer: the grammar is given as productions over
+ * symbols, its LL(1) table (which production a non-terminal expands to for
+ * each kind of lookahead token) is built from their FIRST sets, and the
+ * analyzer runs off an explicit stack of symbols instead of C recursion, so
+ * that the depth of nesting is only bounded by memory.
+ *
+ * The productions replay the recursive analyzer step by step, including its
+ * EXIT_IF_NULL() checks, and so report exactly the same errors.
+ */
+
+/* a symbol is its kind in the upper bits and its value in the lower ones, on
+ * the stack the top bit tells to check for EOF before the symbol */
+#define SYMBOL_VALUE_BITS 12
+#define SYMBOL(kind, value) ((uint16_t)((kind) << SYMBOL_VALUE_BITS | (value)))
+#define SYMBOL_KIND(symbol) ((symbol) >> SYMBOL_VALUE_BITS & 7)
+#define SYMBOL_VALUE(symbol) ((symbol) & ((1 << SYMBOL_VALUE_BITS) - 1))
+#define SYMBOL_EXIT_IF_NULL 0x8000
+
+/* kinds of symbol */
+enum symbol_kind {
+	/* the end of a production */
+	SYMBOL_NONE,
+	/* a token to check, the value indexes the checks */
+	SYMBOL_TERMINAL,
+	/* a non-terminal to expand (see &enum table_non_terminal) */
+	SYMBOL_NON_TERMINAL,
+	/* the end of a non-terminal */
+	SYMBOL_EXIT,
+	/* the error of a non-terminal seeing none of its alternatives */
+	SYMBOL_ERROR,
+	/* an action (see &enum table_action) */
+	SYMBOL_ACTION
+};
+
+/* the non-terminals of the grammar, the first ones being the non-terminals of
+ * &enum non_terminal, the others being the repetitions and options the
+ * recursive analyzer codes as loops and conditions (not in the AST) */
+enum table_non_terminal {
+	NT_STATEMENT_TAIL = NON_TERMINAL_COUNT,
+	NT_READ_TAIL,
+	NT_WRITE_TAIL,
+	NT_ELSE_PART,
+	NT_RELATION_PART,
+	NT_SIGN,
+	NT_ADDING_TAIL,
+	NT_MULTIPLYING_TAIL,
+	TABLE_NON_TERMINAL_COUNT
+};
+
+/* the actions of the grammar */
+enum table_action {
+	/* EXIT_IF_NULL() */
+	ACTION_EXIT_IF_NULL,
+	/* read the first token */
+	ACTION_LEX,
+	/* check for junk after the end of the program */
+	ACTION_CHECK_JUNK,
+	/* record the end of a <compound_statement> for a &Document */
+	ACTION_END_BLOCK,
+	/* go on with the statements of a <compound_statement> after the
+	 * recovery from a missing end */
+	ACTION_RESUME_STATEMENTS
+};
+
+/* the column of the LL(1) table for the lookahead being EOF */
+#define TABLE_EOF_COLUMN (TOKEN_KIND_COUNT + 1)
+#define TABLE_COLUMN_COUNT (TOKEN_KIND_COUNT + 2)
+
+/**
+ * table_parse() - run the table-driven syntax analyzer on the input of the
+ * context.
+ * @context: 	the &Parse_Context
+ */
+void table_parse(Parse_Context *context);
+
+#endif /* SYNTAX_TABLE_H */
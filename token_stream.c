@@ -0,0 +1,159 @@
+#include "token_stream.h"
+#include "context.h"
+#include <stdlib.h>
+#include <string.h>
+
+_Static_assert(TOKEN_KIND_COUNT < 256, "token kinds do not fit in a byte");
+
+/* make room for @count tokens */
+static void reserve_tokens(Token_Stream *stream, size_t count)
+{
+	if (count <= stream->capacity)
+		return;
+	stream->capacity = count > stream->capacity * 2 ? count
+							: stream->capacity * 2;
+	stream->kinds = (uint8_t *)realloc(stream->kinds, stream->capacity);
+	stream->offsets = (uint32_t *)realloc(
+	    stream->offsets, stream->capacity * sizeof(uint32_t));
+	stream->lengths = (uint16_t *)realloc(
+	    stream->lengths, stream->capacity * sizeof(uint16_t));
+}
+
+/* start a new run of tokens at the token being added */
+static void add_position(Token_Stream *stream, int line_number,
+			 int64_t col_delta)
+{
+	if (stream->position_count == stream->position_capacity) {
+		stream->position_capacity = stream->position_capacity * 2 + 256;
+		stream->positions = (Stream_Position *)realloc(
+		    stream->positions,
+		    stream->position_capacity * sizeof(Stream_Position));
+	}
+	Stream_Position *position = stream->positions + stream->position_count++;
+	position->token = stream->count;
+	position->line_number = line_number;
+	position->col_delta = col_delta;
+}
+
+int fill_token_stream(Parse_Context *context)
+{
+	Token_Stream *stream = &context->token_stream;
+	Lexer *lexer = &context->lexer;
+	if (lexer->input.length > UINT32_MAX)
+		return -1;
+	/* a token of each kind stands for all the tokens of its kind */
+	memset(stream->kind_tokens, 0, sizeof(stream->kind_tokens));
+	for (int i = 0; token_list[i]; ++i) {
+		if (!stream->kind_tokens[token_list[i]->kind])
+			stream->kind_tokens[token_list[i]->kind] = token_list[i];
+	}
+
+	stream->count = 0;
+	stream->position_count = 0;
+	stream->error_count = 0;
+	stream->state = STREAM_FILLING;
+	stream->tab_token = SIZE_MAX;
+	/* about one token every 4 bytes in usual sources, which saves the
+	 * copies of growing the arrays from scratch */
+	reserve_tokens(stream, lexer->input.length / 4 + 4096);
+	size_t start_cursor = lexer->cursor;
+	Lex_Token *lex_token;
+	while ((lex_token = lex(context))) {
+		if (lexer->has_tab_space && stream->tab_token == SIZE_MAX)
+			stream->tab_token = stream->count;
+		reserve_tokens(stream, stream->count + 1);
+		int64_t end = lex_token->offset + lex_token->length;
+		int64_t col_delta = lexer->col_number - end;
+		Stream_Position *last;
+		if (!stream->position_count ||
+		    (last = stream->positions + stream->position_count - 1)
+			    ->line_number != lexer->line_number ||
+		    last->col_delta != col_delta)
+			add_position(stream, lexer->line_number, col_delta);
+		stream->kinds[stream->count] = lex_token->token->kind;
+		stream->offsets[stream->count] = lex_token->offset;
+		stream->lengths[stream->count] = lex_token->length;
+		++stream->count;
+	}
+	if (lexer->has_tab_space && stream->tab_token == SIZE_MAX)
+		stream->tab_token = stream->count;
+	stream->end_line_number = lexer->line_number;
+	stream->end_col_number = lexer->col_number;
+	stream->end_cursor = lexer->cursor;
+	lexer->cursor = start_cursor;
+	lexer->has_tab_space = 0;
+
+	stream->state = STREAM_READING;
+	stream->next = 0;
+	stream->next_position = 0;
+	stream->next_error = 0;
+	return 0;
+}
+
+Lex_Token *next_stream_token(Parse_Context *context)
+{
+	Token_Stream *stream = &context->token_stream;
+	Lexer *lexer = &context->lexer;
+	size_t index = stream->next;
+	/* the lexical errors found on the way come before the token */
+	while (stream->next_error < stream->error_count &&
+	       stream->errors[stream->next_error].before <= index) {
+		Stream_Error *error = stream->errors + stream->next_error++;
+		add_error(context, error->id, 0, error->message,
+			  error->line_number, error->start_col,
+			  error->end_col);
+	}
+	if (index >= stream->tab_token)
+		lexer->has_tab_space = 1;
+	if (index == stream->count) {
+		lexer->line_number = stream->end_line_number;
+		lexer->col_number = stream->end_col_number;
+		lexer->cursor = stream->end_cursor;
+		return NULL;
+	}
+	while (stream->next_position < stream->position_count &&
+	       stream->positions[stream->next_position].token <= index)
+		++stream->next_position;
+	Stream_Position *position =
+	    stream->positions + stream->next_position - 1;
+
+	/* the lexer is left as if it had just lexed the token */
+	Lex_Token *lex_token = &lexer->lex_token;
+	lex_token->offset = stream->offsets[index];
+	lex_token->length = stream->lengths[index];
+	lex_token->token = stream->kind_tokens[stream->kinds[index]];
+	lexer->cursor = lex_token->offset + lex_token->length;
+	lexer->line_number = position->line_number;
+	lexer->col_number =
+	    lex_token->offset + lex_token->length + position->col_delta;
+	++stream->next;
+	return lex_token;
+}
+
+void add_stream_error(Parse_Context *context, int id, char *message,
+		      int line_number, int start_col, int end_col)
+{
+	Token_Stream *stream = &context->token_stream;
+	if (stream->error_count == stream->error_capacity) {
+		stream->error_capacity = stream->error_capacity * 2 + 64;
+		stream->errors = (Stream_Error *)realloc(
+		    stream->errors, stream->error_capacity * sizeof(Stream_Error));
+	}
+	Stream_Error *error = stream->errors + stream->error_count++;
+	error->before = stream->count;
+	error->id = id;
+	error->message = message;
+	error->line_number = line_number;
+	error->start_col = start_col;
+	error->end_col = end_col;
+}
+
+void clean_token_stream(Token_Stream *stream)
+{
+	free(stream->kinds);
+	free(stream->offsets);
+	free(stream->lengths);
+	free(stream->positions);
+	free(stream->errors);
+	memset(stream, 0, sizeof(Token_Stream));
+}
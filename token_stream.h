@@ -0,0 +1,157 @@
+#ifndef TOKEN_STREAM_H
+#define TOKEN_STREAM_H
+
+#include "lexical.h"
+#include "setting.h"
+#include "token_table.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * The token stream holds the tokens of a whole input, lexed before the syntax
+ * analyzer starts (--lex-first), as a structure of arrays: for the i-th token,
+ * @kinds[i] is its kind, @offsets[i] and @lengths[i] its lexeme. The syntax
+ * analyzer then gets its tokens from lex() by index, the lexical errors being
+ * replayed before the token they came before so that the messages are the same
+ * as when both analyzers interleave.
+ */
+
+#if MAX_LEXEME_LENGTH > UINT16_MAX
+#error "MAX_LEXEME_LENGTH does not fit the lengths of the token stream"
+#endif
+
+/* what the token stream is used for */
+enum stream_state {
+	/* not used, lex() lexes the input */
+	STREAM_OFF,
+	/* the tokens from lex() go to the stream */
+	STREAM_FILLING,
+	/* lex() returns the tokens of the stream */
+	STREAM_READING
+};
+
+/**
+ * struct stream_position (Stream_Position) - where a run of tokens is, as the
+ * lexer reports it right after each of them.
+ * @token:		index of the first token of the run
+ * @line_number:	the line of the tokens
+ * @col_delta:		the column after a token minus the offset after it,
+ * 			the same for the whole run (i.e. until the next line
+ * 			or the next tab)
+ */
+typedef struct stream_position {
+	uint32_t token;
+	int line_number;
+	int64_t col_delta;
+} Stream_Position;
+
+/**
+ * struct stream_error (Stream_Error) - a lexical error of the token stream.
+ * @before:	index of the token the error comes before
+ * @id:		the kind of error (see &enum error_id)
+ * @message:	the error message (a string literal of the lexer)
+ * @line_number:	the line of the error
+ * @start_col:	the column where the error starts
+ * @end_col:	the column where the error ends
+ */
+typedef struct stream_error {
+	uint32_t before;
+	int id;
+	char *message;
+	int line_number;
+	int start_col;
+	int end_col;
+} Stream_Error;
+
+/**
+ * struct token_stream (Token_Stream) - the tokens of a whole input.
+ * @state:		what the stream is used for (see &enum stream_state)
+ * @kinds:		for each token, its kind (see &enum token_kind)
+ * @offsets:		for each token, the position of its lexeme
+ * @lengths:		for each token, the length of its lexeme
+ * @count:		the number of tokens
+ * @capacity:		the allocated number of tokens
+ * @positions:		the runs of tokens sharing the same line and column
+ * 			delta
+ * @position_count:	the number of positions
+ * @position_capacity:	the allocated number of positions
+ * @errors:		the lexical errors, in order
+ * @error_count:	the number of lexical errors
+ * @error_capacity:	the allocated number of lexical errors
+ * @end_line_number:	the line the lexer ends on
+ * @end_col_number:	the column the lexer ends on
+ * @end_cursor:		the position the lexer ends on
+ * @tab_token:		index of the token whose lexing first spotted a tab
+ * 			(SIZE_MAX if none), the tab warning depending on how
+ * 			far the syntax analyzer reads
+ * @next:		index of the next token to be read
+ * @next_position:	index of the next position to be read
+ * @next_error:		index of the next lexical error to be read
+ * @kind_tokens:	for each kind, the first token of the token list of
+ * 			this kind, which the tokens read are associated with
+ * 			(the syntax analyzer only tells them apart by kind)
+ *
+ * The arrays are kept from one input to the next.
+ */
+typedef struct token_stream {
+	int state;
+	uint8_t *kinds;
+	uint32_t *offsets;
+	uint16_t *lengths;
+	size_t count;
+	size_t capacity;
+	Stream_Position *positions;
+	size_t position_count;
+	size_t position_capacity;
+	Stream_Error *errors;
+	size_t error_count;
+	size_t error_capacity;
+	int end_line_number;
+	int end_col_number;
+	size_t end_cursor;
+	size_t tab_token;
+	size_t next;
+	size_t next_position;
+	size_t next_error;
+	Token *kind_tokens[TOKEN_KIND_COUNT + 1];
+} Token_Stream;
+
+/**
+ * fill_token_stream() - lex the whole input of the context into its token
+ * stream, then have lex() read from it.
+ * @context:	the &Parse_Context, with its input loaded
+ *
+ * Return: 	0: success
+ * 		-1: the input is too large for 32-bit offsets (lex() then
+ * 		lexes it as usual)
+ */
+int fill_token_stream(Parse_Context *context);
+
+/**
+ * next_stream_token() - hand the next token of the stream to the syntax
+ * analyzer, as lex() would, after adding the lexical errors before it.
+ * @context:	the &Parse_Context
+ *
+ * Return: 	the next &Lex_Token, or NULL if EOF
+ */
+Lex_Token *next_stream_token(Parse_Context *context);
+
+/**
+ * add_stream_error() - keep a lexical error found while filling the stream.
+ * @context:	the &Parse_Context
+ * @id:		the kind of error (see &enum error_id)
+ * @message:	the error message
+ * @line_number:	the line of the error
+ * @start_col:	the column where the error starts
+ * @end_col:	the column where the error ends
+ */
+void add_stream_error(Parse_Context *context, int id, char *message,
+		      int line_number, int start_col, int end_col);
+
+/**
+ * clean_token_stream() - free the arrays of a token stream.
+ * @stream:	the &Token_Stream
+ */
+void clean_token_stream(Token_Stream *stream);
+
+#endif /* TOKEN_STREAM_H */
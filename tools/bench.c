@@ -0,0 +1,201 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * bench - run the parser over input files and write its throughput as JSON,
+ * so that it can be compared from one commit to the next.
+ *
+ * Usage: bench [--runs <n>] [--label <text>] [--output <file>] <parser>
+ *		<input_file>...
+ *
+ * Each file is parsed --runs times (5 by default) with and without
+ * --lex-only, the best time of each being kept. The report (written to
+ * --output, the standard output by default) gives for each file its size,
+ * its number of tokens, the exit status of the parser, the wall-clock time of
+ * the whole run in milliseconds, the throughput in MB/s and tokens/s, and the
+ * peak resident set size in KB. The time is also split into phases: lexing
+ * (as the lexer reports it with --lex-only), parsing (what the whole run
+ * takes on top of the run with --lex-only) and the rest (loading the token
+ * definitions and the input, and printing the messages). --label (e.g. the
+ * commit) is copied to the report.
+ */
+
+/**
+ * struct run (Run) - the outcome of the runs of the parser on a file.
+ * @status:	the exit status of the parser (-1 if it did not exit)
+ * @seconds:	the best wall-clock time
+ * @max_rss:	the peak resident set size (in KB)
+ * @token_count:	the number of tokens the parser reported (with
+ * 			--lex-only)
+ * @lex_seconds:	the best time of the lexer the parser reported (with
+ * 			--lex-only)
+ */
+typedef struct run {
+	int status;
+	double seconds;
+	long max_rss;
+	size_t token_count;
+	double lex_seconds;
+} Run;
+
+static double now(void)
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/* run the parser once with the given arguments, reading the report of the
+ * lexer in its output if @is_lex_only */
+static int run_once(char **arguments, int is_lex_only, Run *run)
+{
+	int pipe_ends[2];
+	if (is_lex_only && pipe(pipe_ends))
+		return -1;
+	double start = now();
+	pid_t pid = fork();
+	if (pid < 0)
+		return -1;
+	if (!pid) {
+		int out = is_lex_only ? pipe_ends[1]
+				      : open("/dev/null", O_WRONLY);
+		dup2(out, STDOUT_FILENO);
+		if (is_lex_only)
+			close(pipe_ends[0]);
+		execv(arguments[0], arguments);
+		_exit(127);
+	}
+	if (is_lex_only) {
+		close(pipe_ends[1]);
+		FILE *output = fdopen(pipe_ends[0], "r");
+		char *line = NULL;
+		size_t capacity = 0;
+		/* the report comes after the lexical errors */
+		while (getline(&line, &capacity, output) > 0) {
+			char *report = strstr(line, "lexed ");
+			double lex_ms;
+			if (report &&
+			    sscanf(report, "lexed %zu token(s) in %lf ms",
+				   &run->token_count, &lex_ms) == 2 &&
+			    (!run->lex_seconds || lex_ms / 1e3 < run->lex_seconds))
+				run->lex_seconds = lex_ms / 1e3;
+		}
+		free(line);
+		fclose(output);
+	}
+	int status;
+	struct rusage usage;
+	if (wait4(pid, &status, 0, &usage) < 0)
+		return -1;
+	double seconds = now() - start;
+	if (!run->seconds || seconds < run->seconds)
+		run->seconds = seconds;
+	if (usage.ru_maxrss > run->max_rss)
+		run->max_rss = usage.ru_maxrss;
+	run->status = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+	return 0;
+}
+
+static void print_json_string(FILE *out, const char *text)
+{
+	fputc('"', out);
+	for (; *text; ++text) {
+		if (*text == '"' || *text == '\\')
+			fputc('\\', out);
+		if ((unsigned char)*text < 0x20)
+			fprintf(out, "\\u%04x", *text);
+		else
+			fputc(*text, out);
+	}
+	fputc('"', out);
+}
+
+int main(int argc, char **argv)
+{
+	int run_count = 5;
+	char *label = "";
+	char *output_name = NULL;
+	int argument = 1;
+	for (; argument + 1 < argc && !strncmp(argv[argument], "--", 2);
+	     argument += 2) {
+		if (!strcmp(argv[argument], "--runs"))
+			run_count = atoi(argv[argument + 1]);
+		else if (!strcmp(argv[argument], "--label"))
+			label = argv[argument + 1];
+		else if (!strcmp(argv[argument], "--output"))
+			output_name = argv[argument + 1];
+		else
+			break;
+	}
+	if (argument + 1 >= argc || run_count < 1) {
+		printf("Usage: %s [--runs <n>] [--label <text>] [--output "
+		       "<file>] <parser> <input_file>...\n",
+		       argv[0]);
+		return 1;
+	}
+	char *parser = argv[argument++];
+	FILE *out = stdout;
+	if (output_name && !(out = fopen(output_name, "w"))) {
+		printf("ERROR - cannot open %s\n", output_name);
+		return 1;
+	}
+
+	fprintf(out, "{\"label\":");
+	print_json_string(out, label);
+	fprintf(out, ",\"runs\":%d,\"files\":[", run_count);
+	int has_failed = 0;
+	for (int i = argument; i < argc; ++i) {
+		struct stat file_stat;
+		if (stat(argv[i], &file_stat)) {
+			fprintf(stderr, "ERROR - cannot open %s\n", argv[i]);
+			has_failed = 1;
+			continue;
+		}
+		char *parse_arguments[] = {parser, argv[i], NULL};
+		char *lex_arguments[] = {parser, "--lex-only", argv[i], NULL};
+		Run parse_run = {0}, lex_run = {0};
+		for (int j = 0; j < run_count; ++j) {
+			if (run_once(parse_arguments, 0, &parse_run) ||
+			    run_once(lex_arguments, 1, &lex_run)) {
+				fprintf(stderr, "ERROR - cannot run %s\n",
+					parser);
+				return 1;
+			}
+		}
+		/* the lexer reports its own time, the rest of the run with
+		 * --lex-only being neither lexing nor parsing */
+		size_t token_count = lex_run.token_count;
+		double wall_ms = parse_run.seconds * 1e3;
+		double lex_ms = lex_run.lex_seconds * 1e3;
+		double other_ms = lex_run.seconds * 1e3 - lex_ms;
+		double parse_ms = wall_ms - lex_run.seconds * 1e3;
+		if (other_ms < 0)
+			other_ms = 0;
+		if (parse_ms < 0)
+			parse_ms = 0;
+
+		fprintf(out, "%s\n{\"name\":", i > argument ? "," : "");
+		print_json_string(out, argv[i]);
+		fprintf(out,
+			",\"bytes\":%lld,\"tokens\":%zu,\"status\":%d,"
+			"\"wall_ms\":%.3f,\"lex_ms\":%.3f,\"parse_ms\":%.3f,"
+			"\"other_ms\":%.3f,\"mb_per_s\":%.3f,"
+			"\"tokens_per_s\":%.0f,\"peak_rss_kb\":%ld}",
+			(long long)file_stat.st_size, token_count,
+			parse_run.status, wall_ms, lex_ms, parse_ms, other_ms,
+			file_stat.st_size / 1e6 / parse_run.seconds,
+			token_count / parse_run.seconds, parse_run.max_rss);
+		fflush(out);
+	}
+	fprintf(out, "\n]}\n");
+	if (out != stdout)
+		fclose(out);
+	return has_failed;
+}
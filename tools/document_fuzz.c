@@ -0,0 +1,213 @@
+#include "../merc.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+/*
+ * document_fuzz - check the incremental parse of the library (merc_document_*)
+ * against a full parse: each input file is opened as a document, then edited
+ * at random, the diagnostics of the document after each edit having to be the
+ * ones merc_parse_buffer() gives for the same content.
+ *
+ * Usage: document_fuzz [--seed <n>] [--edits <n>] <input_file>...
+ *
+ * The edits (--edits per file, 1000 by default) delete, insert or replace a
+ * few bytes with fragments of programs, newlines and stray characters, from
+ * a pseudo-random sequence given by --seed (1 by default) so that a failure
+ * can be replayed. The first mismatch is printed with the edit leading to it,
+ * and the exit status is then 1.
+ */
+
+/* what the edits insert, biased towards what opens and closes blocks */
+static const char *const fragments[] = {
+    "begin ", "begin\n", " end", "end ;\n", "end", ";", " ; ", "\n", "\n\n",
+    "if ", " then ", " else ", "while ", " do ", ":= ", "read ( n ) ;\n",
+    "write ( total )", "x", "total", "Prog", "1", "42", " + ", " * ", "- ",
+    "(", ")", " < ", ">=", "<>", ",", "$", "@", "#", "# comment\n", "\t",
+    "program Edited\n", "begin\n    x := 1\nend\n", "while a < b do begin\n",
+    "if ( a ) then b := 2 else c := 3 ;\n",
+    "abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrst"
+    "uvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnop"};
+
+#define FRAGMENT_COUNT (sizeof(fragments) / sizeof(fragments[0]))
+
+/* the longest range an edit replaces */
+#define MAX_EDIT_RANGE 24
+
+/* xorshift64*, the sequence only depending on the seed */
+static uint64_t next_random(uint64_t *state)
+{
+	*state ^= *state >> 12;
+	*state ^= *state << 25;
+	*state ^= *state >> 27;
+	return *state * 2685821657736338717ull;
+}
+
+/**
+ * struct text (Text) - the content of the document, kept apart to be parsed
+ * in full.
+ * @content:	the content
+ * @length:	the length of the content
+ * @capacity:	the allocated size of @content
+ */
+typedef struct text {
+	char *content;
+	size_t length;
+	size_t capacity;
+} Text;
+
+static void replace_text(Text *text, size_t start, size_t end,
+			 const char *replacement, size_t length)
+{
+	size_t new_length = text->length - (end - start) + length;
+	if (new_length > text->capacity) {
+		text->capacity = new_length * 2;
+		text->content = (char *)realloc(text->content, text->capacity);
+	}
+	memmove(text->content + start + length, text->content + end,
+		text->length - end);
+	memcpy(text->content + start, replacement, length);
+	text->length = new_length;
+}
+
+static void print_diagnostic(const char *origin, Merc_Diagnostic *diagnostic)
+{
+	printf("  %s: %d:%d-%d %s %s\n", origin, diagnostic->line,
+	       diagnostic->start_column, diagnostic->end_column,
+	       diagnostic->id, diagnostic->message);
+}
+
+/* compare the diagnostics of the document with the ones of the full parse,
+ * printing them on a mismatch */
+static int compare(Merc_Document *document, Merc_Parser *parser)
+{
+	Merc_Diagnostic expected, actual;
+	int has_expected, has_actual, is_matching = 1;
+	do {
+		has_expected = merc_next_diagnostic(parser, &expected);
+		has_actual = merc_document_next_diagnostic(document, &actual);
+		if (has_expected != has_actual ||
+		    (has_expected &&
+		     (expected.line != actual.line ||
+		      expected.start_column != actual.start_column ||
+		      expected.end_column != actual.end_column ||
+		      strcmp(expected.id, actual.id) ||
+		      strcmp(expected.message, actual.message)))) {
+			is_matching = 0;
+			if (has_expected)
+				print_diagnostic("full parse", &expected);
+			if (has_actual)
+				print_diagnostic("document", &actual);
+		}
+	} while (has_expected || has_actual);
+	return is_matching;
+}
+
+/* edit the content of the file at random, 0 if every edit gave the
+ * diagnostics of a full parse */
+static int fuzz(char *file_name, Text *text, long edit_count, uint64_t *state)
+{
+	Merc_Document *document = merc_create_document();
+	Merc_Parser *parser = merc_create_parser(NULL);
+	/* the document can grow to a few times its size */
+	size_t max_length = text->length * 4 + 1024;
+	int is_matching;
+
+	merc_document_parse(document, text->content, text->length);
+	merc_parse_buffer(parser, text->content, text->length);
+	is_matching = compare(document, parser);
+	if (!is_matching)
+		printf("%s: the first parse differs\n", file_name);
+	for (long i = 0; i < edit_count && is_matching; ++i) {
+		size_t start = next_random(state) % (text->length + 1);
+		size_t range = next_random(state) % (MAX_EDIT_RANGE + 1);
+		size_t end = start + range < text->length ? start + range
+							  : text->length;
+		const char *replacement = "";
+		/* a third of the edits only delete, more if the document got
+		 * too long */
+		if (next_random(state) % 3 && text->length < max_length)
+			replacement =
+			    fragments[next_random(state) % FRAGMENT_COUNT];
+		else
+			end = start + range * 4 < text->length
+				  ? start + range * 4
+				  : text->length;
+		/* half of the others insert without deleting */
+		if (*replacement && next_random(state) % 2)
+			end = start;
+		size_t length = strlen(replacement);
+
+		replace_text(text, start, end, replacement, length);
+		merc_document_edit(document, start, end, replacement, length);
+		merc_parse_buffer(parser, text->content, text->length);
+		is_matching = compare(document, parser);
+		if (!is_matching)
+			printf("%s: edit %ld (replacing [%zu, %zu) with \"%s\") "
+			       "differs\n",
+			       file_name, i + 1, start, end, replacement);
+	}
+	merc_free_parser(parser);
+	merc_free_document(document);
+	return !is_matching;
+}
+
+/* read the whole file, NULL if it cannot be read */
+static char *read_file(char *file_name, size_t *length)
+{
+	FILE *file = fopen(file_name, "rb");
+	if (!file)
+		return NULL;
+	struct stat file_stat;
+	fstat(fileno(file), &file_stat);
+	/* one more byte for an empty file */
+	char *content = (char *)malloc(file_stat.st_size + 1);
+	*length = fread(content, 1, file_stat.st_size, file);
+	fclose(file);
+	return content;
+}
+
+int main(int argc, char **argv)
+{
+	uint64_t seed = 1;
+	long edit_count = 1000;
+	int first_file = 1;
+	for (; first_file < argc && !strncmp(argv[first_file], "--", 2);
+	     ++first_file) {
+		if (!strcmp(argv[first_file], "--seed") &&
+		    first_file + 1 < argc)
+			seed = strtoull(argv[++first_file], NULL, 10);
+		else if (!strcmp(argv[first_file], "--edits") &&
+			 first_file + 1 < argc)
+			edit_count = atol(argv[++first_file]);
+		else
+			break;
+	}
+	if (first_file == argc || !strncmp(argv[first_file], "--", 2)) {
+		fprintf(stderr,
+			"Usage: %s [--seed <n>] [--edits <n>] <input_file>...\n",
+			argv[0]);
+		return 2;
+	}
+
+	int has_failed = 0;
+	for (int i = first_file; i < argc && !has_failed; ++i) {
+		Text text = {0};
+		text.content = read_file(argv[i], &text.length);
+		if (!text.content) {
+			fprintf(stderr, "Cannot read %s\n", argv[i]);
+			return 2;
+		}
+		text.capacity = text.length;
+		/* the files do not get the same edits */
+		uint64_t state = seed * 0x9e3779b97f4a7c15ull + i - first_file + 1;
+		has_failed = fuzz(argv[i], &text, edit_count, &state);
+		free(text.content);
+	}
+	if (!has_failed)
+		printf("SUCCESS - every edit gave the diagnostics of a full "
+		       "parse\n");
+	return has_failed;
+}
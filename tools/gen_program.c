@@ -0,0 +1,388 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * gen_program - generate a program of the grammar of the parser, e.g. for
+ * benchmarking it.
+ *
+ * Usage: gen_program [--seed <n>] [--size <bytes>[K|M|G]] [--depth <n>]
+ *		      [--expr-length <n>] [--comments <percent>]
+ *		      [--tabs <percent>] [--errors <percent>] [--nest <n>]
+ *		      [<output_file>]
+ *
+ * The program is written to <output_file> (the standard output by default),
+ * and is the same for the same options. Statements are added until it is
+ * about --size bytes (64K by default), each structured statement nesting at
+ * most --depth levels (4 by default) and each expression having at most
+ * --expr-length operands (8 by default). A line ends with a comment with a
+ * probability of --comments percent (5 by default), is indented with tabs
+ * instead of spaces with a probability of --tabs percent (0 by default) and a
+ * statement has an error with a probability of --errors percent (0 by
+ * default, i.e. the program is valid).
+ *
+ * With --nest, the program is instead a single statement nesting <n>
+ * structured statements (begin, if and while in turn) around an assignment of
+ * an expression nesting <n> parentheses, e.g. to check how deep the parser
+ * can go.
+ */
+
+/**
+ * struct generator (Generator) - the state of the generation.
+ * @state:		state of the pseudo-random number generator
+ * @out:		the output file
+ * @size:		the number of bytes written
+ * @depth:		the maximum nesting of the statements
+ * @expr_length:	the maximum number of operands of an expression
+ * @comments:		probability (in percent) of a comment at end of line
+ * @tabs:		probability (in percent) of a line indented with tabs
+ * @errors:		probability (in percent) of an error in a statement
+ * @indent:		the current nesting of the statements
+ */
+typedef struct generator {
+	uint64_t state;
+	FILE *out;
+	uint64_t size;
+	int depth;
+	int expr_length;
+	int comments;
+	int tabs;
+	int errors;
+	int indent;
+} Generator;
+
+/* splitmix64, whose output does not depend on the platform */
+static uint64_t next_random(Generator *generator)
+{
+	uint64_t z = (generator->state += 0x9e3779b97f4a7c15ull);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+	return z ^ (z >> 31);
+}
+
+/* a number in [0, bound) */
+static int pick(Generator *generator, int bound)
+{
+	return next_random(generator) % bound;
+}
+
+/* boolean indicates if an event of the given probability (in percent)
+ * happens */
+static int chance(Generator *generator, int percent)
+{
+	return pick(generator, 100) < percent;
+}
+
+static void emit(Generator *generator, const char *text)
+{
+	size_t length = strlen(text);
+	fwrite(text, 1, length, generator->out);
+	generator->size += length;
+}
+
+static void emit_variable(Generator *generator)
+{
+	static const char *names[] = {"a",   "b",     "i",	"n",
+				      "sum", "count", "total", "x1",
+				      "y2",  "temp",  "Value", "index"};
+	emit(generator, names[pick(generator, sizeof(names) / sizeof(*names))]);
+}
+
+static void emit_constant(Generator *generator)
+{
+	char constant[16];
+	snprintf(constant, sizeof(constant), "%d",
+		 pick(generator, 4) ? pick(generator, 100)
+				    : pick(generator, 1000000));
+	emit(generator, constant);
+}
+
+/* end the line, with a comment or not, and indent the next one */
+static void new_line(Generator *generator)
+{
+	static const char *comments[] = {
+	    " # keep the running sum", " # TODO check the bounds",
+	    " # read both operands first", " # begin end if then else",
+	    " #"};
+	if (chance(generator, generator->comments))
+		emit(generator,
+		     comments[pick(generator,
+				   sizeof(comments) / sizeof(*comments))]);
+	emit(generator, "\n");
+	int use_tabs = chance(generator, generator->tabs);
+	for (int i = 0; i < generator->indent; ++i)
+		emit(generator, use_tabs ? "\t" : "    ");
+}
+
+/* an expression of at most @operands operands, parenthesized ones nesting
+ * at most @depth levels */
+static void emit_expression(Generator *generator, int operands, int depth);
+
+static void emit_factor(Generator *generator, int operands, int depth)
+{
+	if (depth > 0 && operands > 1 && !pick(generator, 4)) {
+		emit(generator, "( ");
+		emit_expression(generator, operands, depth - 1);
+		emit(generator, " )");
+	} else if (pick(generator, 2)) {
+		emit_variable(generator);
+	} else {
+		emit_constant(generator);
+	}
+}
+
+static void emit_simple_expression(Generator *generator, int operands,
+				   int depth)
+{
+	static const char *operators[] = {" + ", " - ", " * ", " / "};
+	if (!pick(generator, 8))
+		emit(generator, pick(generator, 2) ? "- " : "+ ");
+	int count = 1 + pick(generator, operands);
+	for (int i = 0; i < count; ++i) {
+		if (i)
+			emit(generator, operators[pick(generator, 4)]);
+		emit_factor(generator, (operands - count) / count + 1, depth);
+	}
+}
+
+static void emit_expression(Generator *generator, int operands, int depth)
+{
+	static const char *operators[] = {" = ",  " <> ", " < ",
+					  " <= ", " >= ", " > "};
+	if (operands > 1 && !pick(generator, 3)) {
+		emit_simple_expression(generator, operands / 2, depth);
+		emit(generator, operators[pick(generator, 6)]);
+		emit_simple_expression(generator, operands - operands / 2,
+				       depth);
+	} else {
+		emit_simple_expression(generator, operands, depth);
+	}
+}
+
+/* an error replacing a statement, as typed by mistake */
+static void emit_error(Generator *generator)
+{
+	switch (pick(generator, 6)) {
+	case 0:
+		/* missing assignment operator */
+		emit_variable(generator);
+		emit(generator, " ");
+		emit_expression(generator, generator->expr_length, 1);
+		break;
+	case 1:
+		/* character which is not part of any token */
+		emit_variable(generator);
+		emit(generator, " := 3.14 $ ");
+		emit_variable(generator);
+		break;
+	case 2:
+		/* misspelled keyword */
+		emit(generator, "writ ( ");
+		emit_variable(generator);
+		emit(generator, " )");
+		break;
+	case 3:
+		/* unbalanced parenthesis */
+		emit(generator, "read ( ");
+		emit_variable(generator);
+		emit(generator, " , ");
+		emit_variable(generator);
+		break;
+	case 4:
+		/* lexeme too long */
+		emit(generator, "x");
+		for (int i = 0; i < 12; ++i)
+			emit(generator, "verylongname");
+		emit(generator, " := 1");
+		break;
+	default:
+		/* missing operand */
+		emit_variable(generator);
+		emit(generator, " := ");
+		emit_variable(generator);
+		emit(generator, " * ");
+		break;
+	}
+}
+
+static void emit_statement(Generator *generator, int depth);
+
+static void emit_compound(Generator *generator, int depth)
+{
+	emit(generator, "begin");
+	++generator->indent;
+	int count = 1 + pick(generator, 4);
+	for (int i = 0; i < count; ++i) {
+		if (i)
+			emit(generator, " ;");
+		new_line(generator);
+		emit_statement(generator, depth);
+	}
+	--generator->indent;
+	new_line(generator);
+	emit(generator, "end");
+}
+
+static void emit_statement(Generator *generator, int depth)
+{
+	if (chance(generator, generator->errors)) {
+		emit_error(generator);
+		return;
+	}
+	/* the structured statements only as long as they can nest */
+	int kind = pick(generator, depth > 0 ? 8 : 4);
+	switch (kind) {
+	case 0:
+	case 1:
+		emit_variable(generator);
+		emit(generator, " := ");
+		emit_expression(generator, generator->expr_length, 2);
+		break;
+	case 2:
+		emit(generator, "read ( ");
+		emit_variable(generator);
+		for (int i = pick(generator, 3); i > 0; --i) {
+			emit(generator, " , ");
+			emit_variable(generator);
+		}
+		emit(generator, " )");
+		break;
+	case 3:
+		emit(generator, "write ( ");
+		emit_expression(generator, generator->expr_length, 1);
+		for (int i = pick(generator, 2); i > 0; --i) {
+			emit(generator, " , ");
+			emit_expression(generator, generator->expr_length, 1);
+		}
+		emit(generator, " )");
+		break;
+	case 4:
+	case 5:
+		emit(generator, "if ");
+		emit_expression(generator, generator->expr_length, 1);
+		emit(generator, " then ");
+		emit_statement(generator, depth - 1);
+		if (pick(generator, 2)) {
+			emit(generator, " else ");
+			emit_statement(generator, depth - 1);
+		}
+		break;
+	case 6:
+		emit(generator, "while ");
+		emit_expression(generator, generator->expr_length, 1);
+		emit(generator, " do ");
+		emit_statement(generator, depth - 1);
+		break;
+	default:
+		emit_compound(generator, depth - 1);
+		break;
+	}
+}
+
+/* a statement nesting @levels structured statements around an assignment of
+ * an expression nesting @levels parentheses, written without recursion nor
+ * indentation so that @levels can be in the millions */
+static void emit_nested(Generator *generator, int levels)
+{
+	static const char *openings[] = {"begin\n", "if a < b then\n",
+					 "while c do\n"};
+	for (int i = 0; i < levels; ++i)
+		emit(generator, openings[i % 3]);
+	emit(generator, "x := ");
+	for (int i = 0; i < levels; ++i)
+		emit(generator, "( ");
+	emit(generator, "1");
+	for (int i = 0; i < levels; ++i)
+		emit(generator, " )");
+	emit(generator, "\n");
+	for (int i = levels - 1; i >= 0; --i) {
+		if (i % 3 == 0)
+			emit(generator, "end\n");
+	}
+}
+
+/* parse a size such as 64K, 10M or 1G */
+static uint64_t parse_size(const char *text)
+{
+	char *end;
+	uint64_t size = strtoull(text, &end, 10);
+	switch (*end) {
+	case 'G':
+		size <<= 10;
+		/* fall through */
+	case 'M':
+		size <<= 10;
+		/* fall through */
+	case 'K':
+		size <<= 10;
+	}
+	return size;
+}
+
+int main(int argc, char **argv)
+{
+	Generator generator = {.depth = 4,
+			       .expr_length = 8,
+			       .comments = 5,
+			       .tabs = 0,
+			       .errors = 0};
+	uint64_t seed = 1, size = 64 << 10;
+	int nest = 0;
+	int argument = 1;
+	for (; argument + 1 < argc && !strncmp(argv[argument], "--", 2);
+	     argument += 2) {
+		char *value = argv[argument + 1];
+		if (!strcmp(argv[argument], "--seed"))
+			seed = strtoull(value, NULL, 10);
+		else if (!strcmp(argv[argument], "--size"))
+			size = parse_size(value);
+		else if (!strcmp(argv[argument], "--depth"))
+			generator.depth = atoi(value);
+		else if (!strcmp(argv[argument], "--expr-length"))
+			generator.expr_length = atoi(value);
+		else if (!strcmp(argv[argument], "--comments"))
+			generator.comments = atoi(value);
+		else if (!strcmp(argv[argument], "--tabs"))
+			generator.tabs = atoi(value);
+		else if (!strcmp(argv[argument], "--errors"))
+			generator.errors = atoi(value);
+		else if (!strcmp(argv[argument], "--nest"))
+			nest = atoi(value);
+		else
+			break;
+	}
+	if (argument + 1 < argc || generator.expr_length < 1 || nest < 0) {
+		printf("Usage: %s [--seed <n>] [--size <bytes>[K|M|G]] "
+		       "[--depth <n>] [--expr-length <n>] [--comments "
+		       "<percent>] [--tabs <percent>] [--errors <percent>] "
+		       "[--nest <n>] [<output_file>]\n",
+		       argv[0]);
+		return 1;
+	}
+	generator.out = stdout;
+	if (argument < argc && !(generator.out = fopen(argv[argument], "w"))) {
+		printf("ERROR - cannot open %s\n", argv[argument]);
+		return 1;
+	}
+	generator.state = seed;
+
+	if (nest) {
+		emit(&generator, "program Generated begin\n");
+		emit_nested(&generator, nest);
+		emit(&generator, "end\n");
+		return fclose(generator.out) ? 1 : 0;
+	}
+	emit(&generator, "program Generated begin");
+	generator.indent = 1;
+	for (int is_first = 1; is_first || generator.size < size; is_first = 0) {
+		if (!is_first)
+			emit(&generator, " ;");
+		new_line(&generator);
+		emit_statement(&generator, generator.depth);
+	}
+	generator.indent = 0;
+	new_line(&generator);
+	emit(&generator, "end\n");
+	return fclose(generator.out) ? 1 : 0;
+}
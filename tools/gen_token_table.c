@@ -0,0 +1,251 @@
+#include "../dfa.h"
+#include "../keyword.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * gen_token_table - generate the built-in token table from a token definition
+ * file, i.e. the token names, the token kinds (enum) and the precompiled token
+ * DFA, so that the parser does not need to read nor compile anything at start.
+ *
+ * Usage: gen_token_table <token_definition_file> <output.c> <output.h>
+ */
+
+/**
+ * struct definition (Definition) - a token read from the definition file.
+ * @name:	name of the token
+ * @pattern:	POSIX regex pattern to match the token
+ */
+typedef struct definition {
+	char name[256];
+	char pattern[1024];
+} Definition;
+
+static void print_c_string(FILE *file, const char *value)
+{
+	fputc('"', file);
+	for (; *value; ++value) {
+		if (*value == '\\' || *value == '"')
+			fputc('\\', file);
+		fputc(*value, file);
+	}
+	fputc('"', file);
+}
+
+static void print_table(FILE *file, const char *type, const char *name,
+			const int16_t *values, int count)
+{
+	fprintf(file, "static const %s %s[%d] = {", type, name, count);
+	for (int i = 0; i < count; ++i)
+		fprintf(file, "%s%d,", i % 16 ? " " : "\n\t", values[i]);
+	fprintf(file, "\n};\n\n");
+}
+
+static int write_header(const char *file_name, Definition *definitions,
+			int count)
+{
+	FILE *file = fopen(file_name, "w");
+	if (!file)
+		return -1;
+	fprintf(file, "/* Generated by tools/gen_token_table, do not edit */\n"
+		      "#ifndef TOKEN_TABLE_H\n"
+		      "#define TOKEN_TABLE_H\n\n"
+		      "#include \"lexical.h\"\n\n"
+		      "/* kind of the tokens, in the order of the token "
+		      "definition file, TOKEN_KIND_COUNT\n"
+		      " * being the kind of any token unknown to the syntax "
+		      "analyzer */\n"
+		      "enum token_kind {\n");
+	for (int i = 0; i < count; ++i)
+		fprintf(file, "\tTOKEN_%s,\n", definitions[i].name);
+	fprintf(file, "\tTOKEN_KIND_COUNT\n"
+		      "};\n\n"
+		      "/* name of each token kind */\n"
+		      "extern const char *token_kind_names[];\n"
+		      "/* the token DFA compiled from the token definition "
+		      "file */\n"
+		      "extern const Dfa builtin_token_dfa;\n"
+		      "/* the keywords of the token definition file */\n"
+		      "extern const Keyword_Table builtin_keyword_table;\n"
+		      "/* the list of token from the token definition file */\n"
+		      "extern Token *builtin_token_list[];\n\n"
+		      "#endif /* TOKEN_TABLE_H */\n");
+	fclose(file);
+	return 0;
+}
+
+static void write_keyword_table(FILE *file, Keyword_Table *table)
+{
+	if (!table->size) {
+		fprintf(file, "const Keyword_Table builtin_keyword_table;\n\n");
+		return;
+	}
+	fprintf(file, "static const char *const builtin_keyword_words[%d] = {",
+		table->size);
+	for (int i = 0; i < table->size; ++i) {
+		fprintf(file, "\n\t");
+		/* keywords are made of word characters only */
+		if (table->words[i])
+			fprintf(file, "\"%.*s\",", table->lengths[i],
+				table->words[i]);
+		else
+			fprintf(file, "NULL,");
+	}
+	fprintf(file, "\n};\n\n");
+	print_table(file, "int16_t", "builtin_keyword_lengths", table->lengths,
+		    table->size);
+	print_table(file, "int16_t", "builtin_keyword_tokens", table->tokens,
+		    table->size);
+	fprintf(file, "const Keyword_Table builtin_keyword_table = {\n"
+		      "\t%uu, %d, %d, {",
+		table->seed, table->size, table->max_length);
+	for (int i = 0; i < 32; ++i)
+		fprintf(file, "%s%d", i ? ", " : "", table->starts[i]);
+	fprintf(file, "},\n\tbuiltin_keyword_words, builtin_keyword_lengths,\n"
+		      "\tbuiltin_keyword_tokens};\n\n");
+}
+
+static int write_source(const char *file_name, const char *header_name,
+			Definition *definitions, int count, Dfa *dfa,
+			Keyword_Table *keywords, int *use_regex)
+{
+	FILE *file = fopen(file_name, "w");
+	if (!file)
+		return -1;
+	const char *header_base = strrchr(header_name, '/');
+	header_base = header_base ? header_base + 1 : header_name;
+	fprintf(file, "/* Generated by tools/gen_token_table, do not edit */\n"
+		      "#include \"%s\"\n\n",
+		header_base);
+
+	fprintf(file, "const char *token_kind_names[] = {\n");
+	for (int i = 0; i < count; ++i)
+		fprintf(file, "\t\"%s\",\n", definitions[i].name);
+	fprintf(file, "\tNULL\n};\n\n");
+
+	int16_t byte_class[256];
+	for (int i = 0; i < 256; ++i)
+		byte_class[i] = dfa->byte_class[i];
+	int size = dfa->state_count * dfa->class_count;
+	print_table(file, "unsigned char", "builtin_byte_class", byte_class,
+		    256);
+	print_table(file, "int16_t", "builtin_dfa_next", dfa->next, size);
+	print_table(file, "int16_t", "builtin_dfa_accept", dfa->accept, size);
+	int16_t *loop_set =
+	    (int16_t *)malloc(dfa->state_count * sizeof(int16_t));
+	for (int i = 0; i < dfa->state_count; ++i)
+		loop_set[i] = dfa->loop_set[i];
+	print_table(file, "unsigned char", "builtin_dfa_loop_set", loop_set,
+		    dfa->state_count);
+	free(loop_set);
+	fprintf(file,
+		"const Dfa builtin_token_dfa = {%d, %d, builtin_byte_class,\n"
+		"\t\t\t\tbuiltin_dfa_next, builtin_dfa_accept,\n"
+		"\t\t\t\tbuiltin_dfa_loop_set};\n\n",
+		dfa->state_count, dfa->class_count);
+	write_keyword_table(file, keywords);
+
+	fprintf(file, "static Token builtin_tokens[] = {\n");
+	for (int i = 0; i < count; ++i) {
+		fprintf(file, "\t{.name = \"%s\",\n\t .pattern = ",
+			definitions[i].name);
+		print_c_string(file, definitions[i].pattern);
+		fprintf(file, ",\n\t .use_regex = %d,\n\t .kind = TOKEN_%s},\n",
+			use_regex[i], definitions[i].name);
+	}
+	fprintf(file, "};\n\n");
+
+	fprintf(file, "Token *builtin_token_list[] = {\n");
+	for (int i = 0; i < count; ++i)
+		fprintf(file, "\tbuiltin_tokens + %d,\n", i);
+	fprintf(file, "\tNULL\n};\n");
+	fclose(file);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 4) {
+		printf("Usage: %s <token_definition_file> <output.c> "
+		       "<output.h>\n",
+		       argv[0]);
+		exit(EXIT_FAILURE);
+	}
+	FILE *token_def_file = fopen(argv[1], "r");
+	if (!token_def_file) {
+		printf("ERROR - cannot open %s\n", argv[1]);
+		exit(EXIT_FAILURE);
+	}
+	/* the header is kept for compatibility, only the number of token
+	 * definitions is used here */
+	int token_list_length, max_token_name_length,
+	    max_token_regex_pattern_length;
+	if (fscanf(token_def_file, "%d %d %d", &token_list_length,
+		   &max_token_name_length,
+		   &max_token_regex_pattern_length) != 3 ||
+	    token_list_length <= 0) {
+		printf("ERROR - invalid header in %s\n", argv[1]);
+		exit(EXIT_FAILURE);
+	}
+	Definition *definitions =
+	    (Definition *)malloc(token_list_length * sizeof(Definition));
+	char **patterns = (char **)malloc(token_list_length * sizeof(char *));
+	int *use_dfa = (int *)malloc(token_list_length * sizeof(int));
+	int *is_keyword = (int *)malloc(token_list_length * sizeof(int));
+	int *use_regex = (int *)malloc(token_list_length * sizeof(int));
+	for (int i = 0; i < token_list_length; ++i) {
+		if (fscanf(token_def_file, "%255s %1023s", definitions[i].name,
+			   definitions[i].pattern) != 2) {
+			printf("ERROR - missing token definition #%d in %s\n",
+			       i + 1, argv[1]);
+			exit(EXIT_FAILURE);
+		}
+		/* the names become enum constants */
+		for (char *c = definitions[i].name; *c; ++c) {
+			if (!isalnum((unsigned char)*c) && *c != '_') {
+				printf("ERROR - invalid token name: %s\n",
+				       definitions[i].name);
+				exit(EXIT_FAILURE);
+			}
+		}
+		patterns[i] = definitions[i].pattern;
+	}
+	fclose(token_def_file);
+
+	/* the keywords are matched with their own table, not the DFA */
+	Keyword_Table keywords;
+	if (keyword_build(&keywords, patterns, token_list_length, is_keyword))
+		printf("WARNING - no perfect hash found for the keywords, they "
+		       "will be matched with the DFA\n");
+	for (int i = 0; i < token_list_length; ++i)
+		use_dfa[i] = !is_keyword[i] && dfa_is_supported(patterns[i]);
+
+	Dfa dfa;
+	if (dfa_build(&dfa, patterns, token_list_length, use_dfa)) {
+		printf("WARNING - token DFA is too large, every token will be "
+		       "matched with regex\n");
+		for (int i = 0; i < token_list_length; ++i)
+			use_dfa[i] = 0;
+		dfa_build(&dfa, patterns, token_list_length, use_dfa);
+	}
+	for (int i = 0; i < token_list_length; ++i)
+		use_regex[i] = !use_dfa[i] && !is_keyword[i];
+	if (write_header(argv[3], definitions, token_list_length) ||
+	    write_source(argv[2], argv[3], definitions, token_list_length, &dfa,
+			 &keywords, use_regex)) {
+		printf("ERROR - cannot write the token table\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/* cleanup */
+	dfa_free(&dfa);
+	keyword_free(&keywords);
+	free(definitions);
+	free(patterns);
+	free(use_dfa);
+	free(is_keyword);
+	free(use_regex);
+	exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,236 @@
+#include "../merc.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * lib_bench - measure what a call of the library (libmerc) costs on small
+ * programs, against running the parser on a temporary file as a service
+ * would have to do without it.
+ *
+ * Usage: lib_bench [--calls <n>] [--threads <n>] [--parse <parser>]
+ *		    [<input_file>]
+ *
+ * Each program (the input file, or two small programs with and without
+ * errors) is parsed --calls times (100000 by default) by the same parser,
+ * then by a parser created and freed for each call, then by --threads
+ * threads at once (the number of processors by default) each with its own
+ * parser. With --parse, the parser given (e.g. ./parse) is also run on the
+ * program written to a temporary file, a hundred times fewer. The times are
+ * the average wall-clock time of a call in microseconds, the diagnostics
+ * being read after each call.
+ */
+
+/* the programs parsed when no input file is given */
+static const char *const programs[][2] = {
+    {"clean", "program Small begin\n"
+	      "    read ( n ) ;\n"
+	      "    total := 0 ;\n"
+	      "    while n > 0 do begin\n"
+	      "        total := total + n * 2 ;\n"
+	      "        n := n - 1\n"
+	      "    end ;\n"
+	      "    if total >= 100 then write ( total ) else write ( 0 )\n"
+	      "end\n"},
+    {"errors", "program Small begin\n"
+	       "    read ( n ) ;\n"
+	       "    total := 0 ;\n"
+	       "    while n > 0 do begin\n"
+	       "        total := total + $ n * 2 ;\n"
+	       "        n := n - \n"
+	       "    end ;\n"
+	       "    if total >= 100 write ( total ) else write ( 0 )\n"
+	       "end\n"}};
+
+/**
+ * struct job (Job) - the calls of a thread.
+ * @content:		the program
+ * @length:		the length of the program
+ * @call_count:		the number of calls
+ * @diagnostic_count:	the number of diagnostics of the program
+ */
+typedef struct job {
+	const char *content;
+	size_t length;
+	long call_count;
+	int diagnostic_count;
+} Job;
+
+static double now(void)
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/* parse the program and read its diagnostics, the number of which is
+ * returned */
+static int parse_once(Merc_Parser *parser, Job *job)
+{
+	Merc_Diagnostic diagnostic;
+	int count = 0;
+	merc_parse_buffer(parser, job->content, job->length);
+	while (merc_next_diagnostic(parser, &diagnostic))
+		++count;
+	return count;
+}
+
+static void *run_job(void *argument)
+{
+	Job *job = (Job *)argument;
+	Merc_Parser *parser = merc_create_parser(NULL);
+	for (long i = 0; i < job->call_count; ++i)
+		job->diagnostic_count = parse_once(parser, job);
+	merc_free_parser(parser);
+	return NULL;
+}
+
+/* run the parser on the file once, its output being discarded */
+static int run_parser(char *parser, char *file_name)
+{
+	pid_t pid = fork();
+	if (pid < 0)
+		return -1;
+	if (!pid) {
+		int out = open("/dev/null", O_WRONLY);
+		dup2(out, STDOUT_FILENO);
+		execl(parser, parser, file_name, (char *)NULL);
+		_exit(127);
+	}
+	int status;
+	waitpid(pid, &status, 0);
+	return WIFEXITED(status) && WEXITSTATUS(status) != 127 ? 0 : -1;
+}
+
+static void bench(const char *name, const char *content, size_t length,
+		  long call_count, int thread_count, char *parser)
+{
+	Job job = {content, length, call_count, 0};
+	double start = now();
+	run_job(&job);
+	double reused = (now() - start) / call_count;
+
+	start = now();
+	for (long i = 0; i < call_count; ++i) {
+		Merc_Parser *parser = merc_create_parser(NULL);
+		parse_once(parser, &job);
+		merc_free_parser(parser);
+	}
+	double created = (now() - start) / call_count;
+
+	pthread_t *threads =
+	    (pthread_t *)malloc(thread_count * sizeof(pthread_t));
+	Job *jobs = (Job *)malloc(thread_count * sizeof(Job));
+	start = now();
+	for (int i = 0; i < thread_count; ++i) {
+		jobs[i] = job;
+		pthread_create(&threads[i], NULL, run_job, &jobs[i]);
+	}
+	int is_consistent = 1;
+	for (int i = 0; i < thread_count; ++i) {
+		pthread_join(threads[i], NULL);
+		is_consistent &=
+		    jobs[i].diagnostic_count == job.diagnostic_count;
+	}
+	double threaded = (now() - start) / ((double)call_count * thread_count);
+	free(threads);
+	free(jobs);
+
+	printf("%s (%zu bytes, %d diagnostic(s)): %.2f us/call with the same "
+	       "parser, %.2f us/call with a new parser, %.2f us/call over %d "
+	       "thread(s)%s",
+	       name, length, job.diagnostic_count, reused * 1e6, created * 1e6,
+	       threaded * 1e6, thread_count,
+	       is_consistent ? "" : " (diagnostics differ)");
+	if (parser) {
+		char file_name[] = "/tmp/lib_bench_XXXXXX";
+		int fd = mkstemp(file_name);
+		long run_count = call_count / 100 > 0 ? call_count / 100 : 1;
+		int has_failed = fd < 0 || write(fd, content, length) !=
+						(ssize_t)length;
+		start = now();
+		for (long i = 0; i < run_count && !has_failed; ++i)
+			has_failed = run_parser(parser, file_name);
+		double spawned = (now() - start) / run_count;
+		if (has_failed)
+			printf(", cannot run %s", parser);
+		else
+			printf(", %.2f us/call with %s", spawned * 1e6, parser);
+		if (fd >= 0) {
+			close(fd);
+			unlink(file_name);
+		}
+	}
+	printf("\n");
+}
+
+/* read the whole file, NULL if it cannot be read */
+static char *read_file(char *file_name, size_t *length)
+{
+	FILE *file = fopen(file_name, "rb");
+	if (!file)
+		return NULL;
+	struct stat file_stat;
+	fstat(fileno(file), &file_stat);
+	/* one more byte for an empty file */
+	char *content = (char *)malloc(file_stat.st_size + 1);
+	*length = fread(content, 1, file_stat.st_size, file);
+	fclose(file);
+	return content;
+}
+
+int main(int argc, char **argv)
+{
+	long call_count = 100000;
+	int thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+	char *parser = NULL;
+	char *file_name = NULL;
+	for (int i = 1; i < argc; ++i) {
+		if (!strcmp(argv[i], "--calls") && i + 1 < argc)
+			call_count = atol(argv[++i]);
+		else if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+			thread_count = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--parse") && i + 1 < argc)
+			parser = argv[++i];
+		else if (!file_name && argv[i][0] != '-')
+			file_name = argv[i];
+		else
+			call_count = 0;
+	}
+	if (call_count <= 0 || thread_count <= 0) {
+		printf("Usage: %s [--calls <n>] [--threads <n>] "
+		       "[--parse <parser>] [<input_file>]\n",
+		       argv[0]);
+		return 1;
+	}
+	/* the token definitions are set up by the first parser */
+	Merc_Parser *first = merc_create_parser(NULL);
+	if (!first) {
+		printf("ERROR - cannot set up the token definitions\n");
+		return 1;
+	}
+	merc_free_parser(first);
+
+	if (file_name) {
+		size_t length;
+		char *content = read_file(file_name, &length);
+		if (!content) {
+			printf("ERROR - cannot open %s\n", file_name);
+			return 1;
+		}
+		bench(file_name, content, length, call_count, thread_count,
+		      parser);
+		free(content);
+		return 0;
+	}
+	for (size_t i = 0; i < sizeof(programs) / sizeof(programs[0]); ++i)
+		bench(programs[i][0], programs[i][1], strlen(programs[i][1]),
+		      call_count, thread_count, parser);
+	return 0;
+}
@@ -0,0 +1,204 @@
+#include "../server.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/*
+ * parse_client - send files to a parse daemon (./parse --serve <socket>) and
+ * print its messages, as ./parse would for each file.
+ *
+ * Usage: parse_client [--data] [--repeat <n>] <socket> <input_file>...
+ *
+ * The files are opened by the daemon unless --data is given, in which case
+ * their content is sent instead. With --repeat, every file is sent n times
+ * (e.g. to benchmark the daemon). The exit status is the highest status of
+ * the responses (0 clean, 1 error(s), 2 cannot be loaded), or 3 if the
+ * daemon cannot be reached.
+ */
+
+/**
+ * struct reader (Reader) - the responses received from the daemon.
+ * @socket:	the connected socket
+ * @buffer:	the received content
+ * @start:	position of the next response in @buffer
+ * @end:	the end of the received content
+ * @capacity:	the allocated size of @buffer
+ */
+typedef struct reader {
+	int socket;
+	char *buffer;
+	size_t start;
+	size_t end;
+	size_t capacity;
+} Reader;
+
+static int receive(Reader *reader, size_t length)
+{
+	if (reader->end - reader->start >= length)
+		return 0;
+	if (reader->start) {
+		memmove(reader->buffer, reader->buffer + reader->start,
+			reader->end - reader->start);
+		reader->end -= reader->start;
+		reader->start = 0;
+	}
+	if (reader->capacity < length) {
+		reader->capacity = length + 65536;
+		reader->buffer =
+		    (char *)realloc(reader->buffer, reader->capacity);
+	}
+	while (reader->end < length) {
+		ssize_t read_size =
+		    recv(reader->socket, reader->buffer + reader->end,
+			 reader->capacity - reader->end, 0);
+		if (read_size <= 0)
+			return -1;
+		reader->end += read_size;
+	}
+	return 0;
+}
+
+static int send_all(int socket, const char *data, size_t length)
+{
+	while (length) {
+		ssize_t write_size = send(socket, data, length, MSG_NOSIGNAL);
+		if (write_size <= 0)
+			return -1;
+		data += write_size;
+		length -= write_size;
+	}
+	return 0;
+}
+
+static char *read_file(const char *file_name, size_t *length)
+{
+	FILE *file = fopen(file_name, "rb");
+	if (!file)
+		return NULL;
+	size_t capacity = 65536;
+	char *content = (char *)malloc(capacity);
+	size_t read_size;
+	*length = 0;
+	while ((read_size = fread(content + *length, 1, capacity - *length,
+				  file)) > 0) {
+		*length += read_size;
+		if (*length == capacity) {
+			capacity *= 2;
+			content = (char *)realloc(content, capacity);
+		}
+	}
+	fclose(file);
+	return content;
+}
+
+/* send a request and print its response, return its status or -1 if the
+ * daemon is gone */
+static int send_request(Reader *reader, char kind, const char *name,
+			const char *payload, size_t length)
+{
+	char header[MAX_HEADER_LENGTH];
+	int written = snprintf(header, sizeof(header), "%c %zu %zu\n", kind,
+			       strlen(name), length);
+	if (send_all(reader->socket, header, written) ||
+	    send_all(reader->socket, name, strlen(name)) ||
+	    send_all(reader->socket, payload, length))
+		return -1;
+
+	char *header_end = NULL;
+	size_t header_length;
+	for (header_length = 1; !header_end; ++header_length) {
+		if (header_length > MAX_HEADER_LENGTH ||
+		    receive(reader, header_length))
+			return -1;
+		header_end = (char *)memchr(reader->buffer + reader->start,
+					    '\n', header_length);
+	}
+	int status;
+	size_t message_length;
+	*header_end = '\0';
+	if (sscanf(reader->buffer + reader->start, "%d %zu", &status,
+		   &message_length) != 2)
+		return -1;
+	header_length = header_end + 1 - (reader->buffer + reader->start);
+	if (receive(reader, header_length + message_length))
+		return -1;
+	fwrite(reader->buffer + reader->start + header_length, 1,
+	       message_length, stdout);
+	reader->start += header_length + message_length;
+	return status;
+}
+
+int main(int argc, char **argv)
+{
+	int is_data = 0, repeat_count = 1, argument = 1;
+	for (; argument < argc && !strncmp(argv[argument], "--", 2);
+	     ++argument) {
+		if (!strcmp(argv[argument], "--data")) {
+			is_data = 1;
+		} else if (!strcmp(argv[argument], "--repeat") &&
+			   argument + 1 < argc) {
+			repeat_count = atoi(argv[++argument]);
+		} else {
+			break;
+		}
+	}
+	if (argc - argument < 2 || repeat_count < 1) {
+		printf("Usage: %s [--data] [--repeat <n>] <socket> "
+		       "<input_file>...\n",
+		       argv[0]);
+		exit(EXIT_FAILURE);
+	}
+
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strncpy(address.sun_path, argv[argument],
+		sizeof(address.sun_path) - 1);
+	Reader reader = {socket(AF_UNIX, SOCK_STREAM, 0), NULL, 0, 0, 0};
+	if (reader.socket < 0 ||
+	    connect(reader.socket, (struct sockaddr *)&address,
+		    sizeof(address))) {
+		printf("ERROR - cannot connect to %s\n", argv[argument]);
+		exit(3);
+	}
+
+	int return_value = 0;
+	for (int i = argument + 1; i < argc && return_value < 3; ++i) {
+		char *name = argv[i];
+		char path[PATH_MAX];
+		size_t length;
+		char *content = is_data ? read_file(name, &length) : NULL;
+		char *payload = content;
+		if (!content) {
+			/* the daemon does not share the working directory, and
+			 * reports the files it cannot load itself */
+			if (!realpath(name, path))
+				snprintf(path, sizeof(path), "%s", name);
+			payload = path;
+			length = strlen(path);
+		}
+		for (int repeat = 0; repeat < repeat_count; ++repeat) {
+			int status = send_request(
+			    &reader, content ? REQUEST_DATA : REQUEST_FILE,
+			    name, payload, length);
+			if (status < 0) {
+				printf("ERROR - connection to %s lost\n",
+				       argv[argument]);
+				return_value = 3;
+				break;
+			}
+			if (status > return_value)
+				return_value = status;
+		}
+		free(content);
+	}
+
+	/* cleanup */
+	close(reader.socket);
+	free(reader.buffer);
+	exit(return_value);
+}
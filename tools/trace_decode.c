@@ -0,0 +1,104 @@
+#include "../trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * trace_decode - print a trace written by ./parse --trace=<trace_file> as the
+ * indented tree of non-terminals the debug build (make debug) prints.
+ *
+ * Usage: trace_decode [--verbose] <trace_file>
+ *
+ * With --verbose, each line starts with the time of the event since the
+ * start of the trace (in microseconds) and the index of the current token.
+ * The trace is read in large blocks, so that traces of any size can be
+ * decoded.
+ */
+
+/* events read at once */
+#define DECODE_BLOCK_SIZE 65536
+
+/* read the names of the non-terminals, NULL if the header is not valid */
+static char **read_names(FILE *file, uint32_t *name_count)
+{
+	char magic[sizeof(TRACE_MAGIC) - 1];
+	uint32_t header[2];
+	if (fread(magic, 1, sizeof(magic), file) != sizeof(magic) ||
+	    memcmp(magic, TRACE_MAGIC, sizeof(magic)) ||
+	    fread(header, sizeof(uint32_t), 2, file) != 2 ||
+	    header[0] != TRACE_VERSION)
+		return NULL;
+	*name_count = header[1];
+	char **names = (char **)calloc(*name_count, sizeof(char *));
+	for (uint32_t i = 0; i < *name_count; ++i) {
+		char *name = NULL;
+		size_t capacity = 0;
+		if (getdelim(&name, &capacity, '\0', file) <= 0) {
+			free(name);
+			return names;
+		}
+		names[i] = name;
+	}
+	return names;
+}
+
+int main(int argc, char **argv)
+{
+	int is_verbose = argc > 1 && !strcmp(argv[1], "--verbose");
+	if (argc != 2 + is_verbose) {
+		printf("Usage: %s [--verbose] <trace_file>\n", argv[0]);
+		return 1;
+	}
+	FILE *file = fopen(argv[1 + is_verbose], "rb");
+	if (!file) {
+		printf("ERROR - cannot open %s\n", argv[1 + is_verbose]);
+		return 1;
+	}
+	uint32_t name_count;
+	char **names = read_names(file, &name_count);
+	if (!names) {
+		printf("ERROR - %s is not a trace of this version\n",
+		       argv[1 + is_verbose]);
+		fclose(file);
+		return 1;
+	}
+
+	Trace_Event *events =
+	    (Trace_Event *)malloc(DECODE_BLOCK_SIZE * sizeof(Trace_Event));
+	size_t count;
+	int depth = 0, has_failed = 0;
+	while ((count = fread(events, sizeof(Trace_Event), DECODE_BLOCK_SIZE,
+			      file))) {
+		for (size_t i = 0; i < count; ++i) {
+			Trace_Event *event = &events[i];
+			if (event->non_terminal >= name_count ||
+			    !names[event->non_terminal]) {
+				has_failed = 1;
+				break;
+			}
+			/* as in indent_depth(), the depth goes up after the
+			 * enter line and down before the exit line */
+			if (event->type == TRACE_EXIT && depth > 0)
+				--depth;
+			if (is_verbose)
+				printf("%12.3f %10u ", event->time / 1e3,
+				       event->token_index);
+			printf("%*s%s (%s)\n", depth * PARSE_DISPLAY_TAB_LENGTH,
+			       "", names[event->non_terminal],
+			       event->type == TRACE_ENTER ? "enter" : "exit");
+			if (event->type == TRACE_ENTER)
+				++depth;
+		}
+		if (has_failed)
+			break;
+	}
+	if (has_failed || ferror(file))
+		printf("ERROR - %s is corrupted\n", argv[1 + is_verbose]);
+
+	for (uint32_t i = 0; i < name_count; ++i)
+		free(names[i]);
+	free(names);
+	free(events);
+	fclose(file);
+	return has_failed;
+}
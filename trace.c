@@ -0,0 +1,76 @@
+#include "trace.h"
+#include "ast.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+_Static_assert(sizeof(Trace_Event) == 16, "trace events are 16 bytes");
+_Static_assert(NON_TERMINAL_COUNT <= UINT8_MAX,
+	       "non-terminals do not fit in a trace event");
+
+uint64_t trace_now(void)
+{
+	struct timespec time;
+	clock_gettime(CLOCK_MONOTONIC, &time);
+	return (uint64_t)time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+/* write the whole buffer, boolean indicates if it failed */
+static int write_all(int fd, const void *data, size_t length)
+{
+	const char *cursor = data;
+	while (length) {
+		ssize_t written = write(fd, cursor, length);
+		if (written <= 0)
+			return 1;
+		cursor += written;
+		length -= written;
+	}
+	return 0;
+}
+
+Trace *open_trace(const char *file_name)
+{
+	int fd = open(file_name, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+		return NULL;
+	Trace *trace = (Trace *)malloc(sizeof(Trace));
+	trace->fd = fd;
+	trace->count = 0;
+	trace->has_failed = 0;
+	trace->events =
+	    (Trace_Event *)malloc(TRACE_BUFFER_SIZE * sizeof(Trace_Event));
+
+	/* the names are written along so that the trace can be decoded
+	 * without the parser */
+	uint32_t header[2] = {TRACE_VERSION, NON_TERMINAL_COUNT};
+	trace->has_failed =
+	    write_all(fd, TRACE_MAGIC, strlen(TRACE_MAGIC)) ||
+	    write_all(fd, header, sizeof(header));
+	for (int i = 0; i < NON_TERMINAL_COUNT && !trace->has_failed; ++i)
+		trace->has_failed =
+		    write_all(fd, non_terminal_names[i],
+			      strlen(non_terminal_names[i]) + 1);
+	trace->start = trace_now();
+	return trace;
+}
+
+void flush_trace(Trace *trace)
+{
+	if (!trace->has_failed)
+		trace->has_failed =
+		    write_all(trace->fd, trace->events,
+			      trace->count * sizeof(Trace_Event));
+	trace->count = 0;
+}
+
+int close_trace(Trace *trace)
+{
+	flush_trace(trace);
+	int has_failed = close(trace->fd) || trace->has_failed;
+	free(trace->events);
+	free(trace);
+	return has_failed ? -1 : 0;
+}
@@ -0,0 +1,98 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "setting.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Binary trace of the syntax analysis (--trace=<file>): an event is recorded
+ * each time the syntax analyzer enters or exits a non-terminal, into a buffer
+ * of TRACE_BUFFER_SIZE events written out at once when full, so that inputs of
+ * any size can be traced without a debug build. tools/trace_decode prints the
+ * trace as the indented tree of the debug build.
+ *
+ * The file starts with TRACE_MAGIC, the version and the number of names of
+ * the non-terminals (both as uint32_t), then the names (each ending with a
+ * NUL), then the &Trace_Event records, all in the byte order of the machine.
+ */
+
+#define TRACE_MAGIC "PARSETRC"
+#define TRACE_VERSION 1
+
+/* the kinds of events */
+enum trace_event_type { TRACE_ENTER, TRACE_EXIT };
+
+/**
+ * struct trace_event (Trace_Event) - a record of the trace.
+ * @time:		nanoseconds since the trace was opened
+ * @token_index:	the index of the current token
+ * @type:		the kind of event (see &enum trace_event_type)
+ * @non_terminal:	the non-terminal entered or exited
+ * @reserved:		0
+ */
+typedef struct trace_event {
+	uint64_t time;
+	uint32_t token_index;
+	uint8_t type;
+	uint8_t non_terminal;
+	uint16_t reserved;
+} Trace_Event;
+
+/**
+ * struct trace (Trace) - an open trace file.
+ * @fd:		the file descriptor of the trace file
+ * @start:	the monotonic time the trace was opened at, in nanoseconds
+ * @count:	the number of events in @events
+ * @has_failed:	boolean indicates if writing the file failed (the events
+ * 		are then dropped)
+ * @events:	the TRACE_BUFFER_SIZE events not written yet
+ */
+typedef struct trace {
+	int fd;
+	uint64_t start;
+	size_t count;
+	int has_failed;
+	Trace_Event *events;
+} Trace;
+
+/**
+ * open_trace() - create the trace file and write its header.
+ * @file_name:	the name of the trace file
+ *
+ * Return:	the &Trace, or NULL if the file could not be created
+ */
+Trace *open_trace(const char *file_name);
+
+/**
+ * flush_trace() - write the buffered events to the trace file.
+ * @trace:	the &Trace
+ */
+void flush_trace(Trace *trace);
+
+/**
+ * close_trace() - write the events left and close the trace file.
+ * @trace:	the &Trace
+ *
+ * Return:	0 if the whole trace was written, -1 otherwise
+ */
+int close_trace(Trace *trace);
+
+/* the monotonic time in nanoseconds */
+uint64_t trace_now(void);
+
+/* record an event (see &Trace_Event) */
+static inline void add_trace_event(Trace *trace, int type, int non_terminal,
+				   size_t token_index)
+{
+	Trace_Event *event = &trace->events[trace->count];
+	event->time = trace_now() - trace->start;
+	event->token_index = token_index;
+	event->type = type;
+	event->non_terminal = non_terminal;
+	event->reserved = 0;
+	if (++trace->count == TRACE_BUFFER_SIZE)
+		flush_trace(trace);
+}
+
+#endif /* TRACE_H */